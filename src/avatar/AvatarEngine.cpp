@@ -7,9 +7,31 @@
 #include <QColor>
 #include <QtMath>
 #include <spdlog/spdlog.h>
+#include <algorithm>
 
 namespace Chatbot {
 
+namespace {
+
+// Rest positions (head in avatar space, facial features relative to the head)
+const QVector3D kHeadBasePosition(0.0f, 1.0f, 0.0f);
+const QVector3D kMouthBasePosition(0.0f, -0.15f, 0.46f);
+constexpr float kLeftBrowX = -0.15f;
+constexpr float kRightBrowX = 0.15f;
+constexpr float kBrowZ = 0.43f;
+
+// Ease in/out over t in [0, 1]
+float smoothStep(float t) {
+    t = std::clamp(t, 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+float lerp(float from, float to, float t) {
+    return from + (to - from) * t;
+}
+
+} // namespace
+
 AvatarEngine::AvatarEngine(Qt3DCore::QEntity *rootEntity, QObject *parent)
     : QObject(parent)
     , m_rootEntity(rootEntity)
@@ -48,8 +70,10 @@ AvatarEngine::AvatarEngine(Qt3DCore::QEntity *rootEntity, QObject *parent)
 
     // Load viseme mapping
     m_visemeMapper->loadMapping("./config/viseme_mapping.json");
-    m_currentViseme = m_visemeMapper->getSilenceViseme();
-    m_targetViseme = m_currentViseme;
+
+    // Start at rest, no blends in progress
+    applyViseme(m_visemeMapper->getSilenceViseme(), 1.0f);
+    m_emotionBlendTime = m_emotionBlendDuration;
 
     createPlaceholderAvatar();
     setupIdleAnimation();
@@ -253,28 +277,96 @@ void AvatarEngine::setAnimationSpeed(float speed) {
 }
 
 void AvatarEngine::updateAnimation(float deltaTime) {
-    if (!m_isAnimating || m_state != AvatarState::Idle) {
-        return;
+    // Blend the mouth toward the target viseme
+    if (m_visemeBlendTime < m_visemeBlendDuration) {
+        m_visemeBlendTime = std::min(m_visemeBlendTime + deltaTime, m_visemeBlendDuration);
+        float t = smoothStep(m_visemeBlendTime / m_visemeBlendDuration);
+        m_mouthCurrent.width = lerp(m_mouthFrom.width, m_mouthTarget.width, t);
+        m_mouthCurrent.height = lerp(m_mouthFrom.height, m_mouthTarget.height, t);
+        m_mouthCurrent.jawOpen = lerp(m_mouthFrom.jawOpen, m_mouthTarget.jawOpen, t);
+        if (m_visemeBlendTime >= m_visemeBlendDuration) {
+            m_currentViseme = m_targetViseme;
+        }
     }
 
-    m_animationTime += deltaTime * m_animationSpeed;
+    // Blend the eyebrows toward the target emotion
+    if (m_emotionBlendTime < m_emotionBlendDuration) {
+        m_emotionBlendTime = std::min(m_emotionBlendTime + deltaTime, m_emotionBlendDuration);
+        float t = smoothStep(m_emotionBlendTime / m_emotionBlendDuration);
+        m_browCurrent.leftY = lerp(m_browFrom.leftY, m_browTarget.leftY, t);
+        m_browCurrent.rightY = lerp(m_browFrom.rightY, m_browTarget.rightY, t);
+        m_browCurrent.leftRotation = lerp(m_browFrom.leftRotation, m_browTarget.leftRotation, t);
+        m_browCurrent.rightRotation = lerp(m_browFrom.rightRotation, m_browTarget.rightRotation, t);
+        if (m_emotionBlendTime >= m_emotionBlendDuration) {
+            m_currentEmotion = m_targetEmotion;
+        }
+    }
 
-    // Gentle bobbing motion (up and down)
-    float bobAmount = 0.03f;  // Very subtle vertical movement
-    float bobFrequency = 1.0f;  // Hz (slow, breathing-like rhythm)
-    float yOffset = bobAmount * qSin(m_animationTime * bobFrequency * 2.0f * M_PI);
+    // Idle motion
+    float yOffset = 0.0f;
+    float rotation = 0.0f;
+    if (m_isAnimating && m_state == AvatarState::Idle) {
+        m_animationTime += deltaTime * m_animationSpeed;
+
+        // Gentle bobbing motion (up and down)
+        float bobAmount = 0.03f;  // Very subtle vertical movement
+        float bobFrequency = 1.0f;  // Hz (slow, breathing-like rhythm)
+        yOffset = bobAmount * qSin(m_animationTime * bobFrequency * 2.0f * M_PI);
+
+        // Gentle head rotation (subtle nod)
+        float rotationAmount = 8.0f;  // degrees (more natural, less exaggerated)
+        float rotationFrequency = 0.6f;  // Hz (slower, calmer)
+        rotation = rotationAmount * qSin(m_animationTime * rotationFrequency * 2.0f * M_PI);
+    }
 
-    // Gentle head rotation (subtle nod)
-    float rotationAmount = 8.0f;  // degrees (more natural, less exaggerated)
-    float rotationFrequency = 0.6f;  // Hz (slower, calmer)
-    float rotation = rotationAmount * qSin(m_animationTime * rotationFrequency * 2.0f * M_PI);
+    m_pose.set(m_pose.headY, kHeadBasePosition.y() + yOffset, AvatarPose::HeadTranslation);
+    m_pose.set(m_pose.headRotationX, rotation, AvatarPose::HeadRotation);  // Nodding
 
-    // Apply transformations
-    QVector3D basePosition(0.0f, 1.0f, 0.0f);
-    m_headTransform->setTranslation(basePosition + QVector3D(0.0f, yOffset, 0.0f));
+    // Scale the mouth mesh to match the viseme's mouth width and height, and
+    // move it down as the jaw opens (depth stays constant: flat mouth)
+    m_pose.set(m_pose.mouthScaleX, 1.2f + (m_mouthCurrent.width * 1.5f), AvatarPose::MouthScale);
+    m_pose.set(m_pose.mouthScaleY, 0.5f + (m_mouthCurrent.height * 1.5f), AvatarPose::MouthScale);
+    m_pose.set(m_pose.mouthY, kMouthBasePosition.y() - m_mouthCurrent.jawOpen * 0.1f, AvatarPose::MouthTranslation);
 
-    // Subtle rotation around X axis (nodding)
-    m_headTransform->setRotationX(rotation);
+    m_pose.set(m_pose.leftBrowY, m_browCurrent.leftY, AvatarPose::LeftBrowTranslation);
+    m_pose.set(m_pose.leftBrowRotation, 90.0f + m_browCurrent.leftRotation, AvatarPose::LeftBrowRotation);
+    m_pose.set(m_pose.rightBrowY, m_browCurrent.rightY, AvatarPose::RightBrowTranslation);
+    m_pose.set(m_pose.rightBrowRotation, 90.0f + m_browCurrent.rightRotation, AvatarPose::RightBrowRotation);
+}
+
+void AvatarEngine::flushPose() {
+    if (m_pose.dirty == 0 || !m_headTransform || !m_mouthTransform
+        || !m_leftEyebrowTransform || !m_rightEyebrowTransform) {
+        return;
+    }
+
+    // Every setter call is synced to the Qt3D backend; skip what didn't change
+    if (m_pose.isDirty(AvatarPose::HeadTranslation)) {
+        m_headTransform->setTranslation(QVector3D(kHeadBasePosition.x(), m_pose.headY, kHeadBasePosition.z()));
+    }
+    if (m_pose.isDirty(AvatarPose::HeadRotation)) {
+        m_headTransform->setRotationX(m_pose.headRotationX);
+    }
+    if (m_pose.isDirty(AvatarPose::MouthTranslation)) {
+        m_mouthTransform->setTranslation(QVector3D(kMouthBasePosition.x(), m_pose.mouthY, kMouthBasePosition.z()));
+    }
+    if (m_pose.isDirty(AvatarPose::MouthScale)) {
+        m_mouthTransform->setScale3D(QVector3D(m_pose.mouthScaleX, m_pose.mouthScaleY, m_pose.mouthScaleZ));
+    }
+    if (m_pose.isDirty(AvatarPose::LeftBrowTranslation)) {
+        m_leftEyebrowTransform->setTranslation(QVector3D(kLeftBrowX, m_pose.leftBrowY, kBrowZ));
+    }
+    if (m_pose.isDirty(AvatarPose::LeftBrowRotation)) {
+        m_leftEyebrowTransform->setRotationZ(m_pose.leftBrowRotation);
+    }
+    if (m_pose.isDirty(AvatarPose::RightBrowTranslation)) {
+        m_rightEyebrowTransform->setTranslation(QVector3D(kRightBrowX, m_pose.rightBrowY, kBrowZ));
+    }
+    if (m_pose.isDirty(AvatarPose::RightBrowRotation)) {
+        m_rightEyebrowTransform->setRotationZ(m_pose.rightBrowRotation);
+    }
+
+    m_pose.dirty = 0;
 }
 
 void AvatarEngine::setPosition(const QVector3D& position) {
@@ -308,40 +400,22 @@ bool AvatarEngine::loadModel(const QString& modelPath) {
 }
 
 void AvatarEngine::applyViseme(const Viseme& viseme, float blendFactor) {
-    if (!m_mouthTransform) {
-        return;
-    }
-
-    // Set target viseme for blending
+    // Set target viseme; the mouth is moved in updateAnimation()
     m_targetViseme = viseme;
+    m_mouthFrom = m_mouthCurrent;
+    m_mouthTarget.width = viseme.mouthWidth;
+    m_mouthTarget.height = viseme.mouthHeight;
+    m_mouthTarget.jawOpen = viseme.jawOpen;
 
     // If immediate application (blendFactor = 1.0), skip blending
     if (blendFactor >= 1.0f) {
         m_currentViseme = viseme;
+        m_mouthCurrent = m_mouthTarget;
         m_visemeBlendTime = m_visemeBlendDuration;
     } else {
         // Start blending
         m_visemeBlendTime = 0.0f;
     }
-
-    // Apply mouth shape based on viseme parameters
-    // Scale the mouth mesh to match the viseme's mouth width and height
-    float baseWidth = 1.2f;
-    float baseHeight = 0.5f;
-    float width = baseWidth + (viseme.mouthWidth * 1.5f);   // Scale width
-    float height = baseHeight + (viseme.mouthHeight * 1.5f); // Scale height
-    float depth = 0.4f;  // Keep depth relatively constant (flat mouth)
-
-    // Apply jaw opening by translating mouth down
-    float jawOffset = viseme.jawOpen * 0.1f;  // Move down when jaw opens
-
-    // Update mouth transform (position relative to head center)
-    QVector3D basePosition(0.0f, -0.15f, 0.46f);  // Head-relative coordinates (updated)
-    m_mouthTransform->setTranslation(basePosition + QVector3D(0.0f, -jawOffset, 0.0f));
-    m_mouthTransform->setScale3D(QVector3D(width, height, depth));
-
-    spdlog::debug("Applied viseme: {} (width={:.2f}, height={:.2f}, jaw={:.2f})",
-                  viseme.name.toStdString(), viseme.mouthWidth, viseme.mouthHeight, viseme.jawOpen);
 }
 
 void AvatarEngine::applyPhoneme(const QString& phoneme) {
@@ -351,7 +425,7 @@ void AvatarEngine::applyPhoneme(const QString& phoneme) {
     }
 
     // Convert phoneme to viseme
-    Viseme viseme = m_visemeMapper->getVisemeForPhoneme(phoneme);
+    const Viseme& viseme = m_visemeMapper->getVisemeForPhoneme(phoneme);
 
     // Apply the viseme
     applyViseme(viseme, 0.5f);  // Use blending
@@ -361,69 +435,63 @@ void AvatarEngine::applyPhoneme(const QString& phoneme) {
 }
 
 void AvatarEngine::applyEmotion(Emotion emotion) {
-    if (!m_leftEyebrowTransform || !m_rightEyebrowTransform) {
-        return;
-    }
-
-    m_currentEmotion = emotion;
+    // Blend the brows from wherever they are now; see updateAnimation()
     m_targetEmotion = emotion;
+    m_browFrom = m_browCurrent;
+    m_browTarget = browShapeForEmotion(emotion);
+    m_emotionBlendTime = 0.0f;
+
+    spdlog::info("Applied emotion: {}", emotionToString(emotion).toStdString());
+}
 
+BrowShape AvatarEngine::browShapeForEmotion(Emotion emotion) {
     // Define eyebrow positions for each emotion
-    // Base position: (x, 0.2, z) with Z rotation 90 degrees (horizontal)
-    QVector3D leftBrowPos(-0.15f, 0.2f, 0.43f);
-    QVector3D rightBrowPos(0.15f, 0.2f, 0.43f);
-    float leftBrowRotation = 0.0f;   // Additional rotation beyond base 90°
-    float rightBrowRotation = 0.0f;
+    // Base position: (x, 0.2, z) with Z rotation 90 degrees (horizontal);
+    // rotations are in addition to the base 90°
+    BrowShape brows;
 
     switch (emotion) {
         case Emotion::Happy:
             // Slightly raised eyebrows
-            leftBrowPos.setY(0.22f);
-            rightBrowPos.setY(0.22f);
+            brows.leftY = 0.22f;
+            brows.rightY = 0.22f;
             break;
 
         case Emotion::Sad:
             // Inner brow raised, outer lowered (frown)
-            leftBrowPos.setY(0.18f);
-            rightBrowPos.setY(0.18f);
-            leftBrowRotation = -10.0f;   // Tilt down on outer edge
-            rightBrowRotation = 10.0f;
+            brows.leftY = 0.18f;
+            brows.rightY = 0.18f;
+            brows.leftRotation = -10.0f;   // Tilt down on outer edge
+            brows.rightRotation = 10.0f;
             break;
 
         case Emotion::Surprised:
             // Eyebrows raised high
-            leftBrowPos.setY(0.28f);
-            rightBrowPos.setY(0.28f);
+            brows.leftY = 0.28f;
+            brows.rightY = 0.28f;
             break;
 
         case Emotion::Worried:
             // Inner brows raised, outer normal
-            leftBrowPos.setY(0.23f);
-            rightBrowPos.setY(0.23f);
-            leftBrowRotation = 15.0f;    // Tilt up on inner edge
-            rightBrowRotation = -15.0f;
+            brows.leftY = 0.23f;
+            brows.rightY = 0.23f;
+            brows.leftRotation = 15.0f;    // Tilt up on inner edge
+            brows.rightRotation = -15.0f;
             break;
 
         case Emotion::Thoughtful:
             // One brow slightly raised
-            leftBrowPos.setY(0.22f);
-            rightBrowPos.setY(0.2f);
+            brows.leftY = 0.22f;
+            brows.rightY = 0.2f;
             break;
 
         case Emotion::Neutral:
         default:
-            // Default positions (already set above)
+            // Default positions
             break;
     }
 
-    // Apply transformations
-    m_leftEyebrowTransform->setTranslation(leftBrowPos);
-    m_leftEyebrowTransform->setRotationZ(90.0f + leftBrowRotation);
-
-    m_rightEyebrowTransform->setTranslation(rightBrowPos);
-    m_rightEyebrowTransform->setRotationZ(90.0f + rightBrowRotation);
-
-    spdlog::info("Applied emotion: {}", emotionToString(emotion).toStdString());
+    return brows;
 }
 
 } // namespace Chatbot
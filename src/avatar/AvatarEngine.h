@@ -1,6 +1,7 @@
 #ifndef CHATBOT_AVATARENGINE_H
 #define CHATBOT_AVATARENGINE_H
 
+#include "avatar/AvatarPose.h"
 #include "avatar/VisemeMapper.h"
 #include "emotion/EmotionDetector.h"
 #include <QObject>
@@ -34,6 +35,21 @@ enum class AvatarState {
     Listening
 };
 
+// Blendable mouth parameters (viseme values, 0.0 to 1.0)
+struct MouthShape {
+    float width = 0.0f;
+    float height = 0.0f;
+    float jawOpen = 0.0f;
+};
+
+// Blendable eyebrow parameters (head-local height, extra Z rotation in degrees)
+struct BrowShape {
+    float leftY = 0.2f;
+    float rightY = 0.2f;
+    float leftRotation = 0.0f;
+    float rightRotation = 0.0f;
+};
+
 class AvatarEngine : public QObject {
     Q_OBJECT
 
@@ -65,6 +81,7 @@ public:
     // Lip-sync / Viseme control
     void applyViseme(const Viseme& viseme, float blendFactor = 1.0f);
     void applyPhoneme(const QString& phoneme);
+    const VisemeMapper* getVisemeMapper() const { return m_visemeMapper.get(); }
 
     // Emotion / Expression control
     void applyEmotion(Emotion emotion);
@@ -76,11 +93,18 @@ signals:
     void stateChanged(AvatarState newState);
 
 public slots:
+    // Advances idle motion and viseme/emotion blends into the pose buffer;
+    // runs every frame in every state
     void updateAnimation(float deltaTime);
 
+    // Copies the changed parts of the pose to the Qt3D transforms; call once
+    // per frame after updateAnimation()
+    void flushPose();
+
 private:
     void createPlaceholderAvatar();
     void setupIdleAnimation();
+    static BrowShape browShapeForEmotion(Emotion emotion);
 
 private:
     Qt3DCore::QEntity* m_rootEntity;
@@ -113,6 +137,7 @@ private:
     Qt3DExtras::QPhongMaterial* m_eyebrowMaterial;
 
     // Animation
+    AvatarPose m_pose;
     AvatarState m_state;
     float m_animationTime;
     float m_animationSpeed;
@@ -122,12 +147,18 @@ private:
     std::unique_ptr<VisemeMapper> m_visemeMapper;
     Viseme m_currentViseme;
     Viseme m_targetViseme;
+    MouthShape m_mouthFrom;     // Shape when the current blend started
+    MouthShape m_mouthCurrent;
+    MouthShape m_mouthTarget;
     float m_visemeBlendTime;
     float m_visemeBlendDuration;
 
     // Emotion / Expression
     Emotion m_currentEmotion;
     Emotion m_targetEmotion;
+    BrowShape m_browFrom;
+    BrowShape m_browCurrent;
+    BrowShape m_browTarget;
     float m_emotionBlendTime;
     float m_emotionBlendDuration;
 };
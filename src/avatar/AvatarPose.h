@@ -0,0 +1,60 @@
+#ifndef CHATBOT_AVATARPOSE_H
+#define CHATBOT_AVATARPOSE_H
+
+#include <QtGlobal>
+
+namespace Chatbot {
+
+/**
+ * AvatarPose is the per-frame pose of the placeholder avatar as plain
+ * floats. Animation code writes here as often as it likes; AvatarEngine
+ * copies it to the Qt3D transforms once per frame, and only the parts
+ * whose values changed, so each frame costs at most one backend sync per
+ * transform property.
+ */
+struct AvatarPose {
+    // Parts of the pose, one per Qt3D transform property
+    enum Part : quint32 {
+        HeadTranslation      = 1u << 0,
+        HeadRotation         = 1u << 1,
+        MouthTranslation     = 1u << 2,
+        MouthScale           = 1u << 3,
+        LeftBrowTranslation  = 1u << 4,
+        LeftBrowRotation     = 1u << 5,
+        RightBrowTranslation = 1u << 6,
+        RightBrowRotation    = 1u << 7,
+        All                  = 0xffu
+    };
+
+    // Head (avatar space)
+    float headY = 1.0f;
+    float headRotationX = 0.0f;  // Degrees
+
+    // Mouth (head space)
+    float mouthY = -0.15f;
+    float mouthScaleX = 1.2f;
+    float mouthScaleY = 0.5f;
+    float mouthScaleZ = 0.4f;
+
+    // Eyebrows (head space), rotations in degrees around Z
+    float leftBrowY = 0.2f;
+    float leftBrowRotation = 90.0f;
+    float rightBrowY = 0.2f;
+    float rightBrowRotation = 90.0f;
+
+    quint32 dirty = All;  // Parts changed since the last flush
+
+    // Update a field, marking its part dirty if the value changed
+    void set(float& field, float value, Part part) {
+        if (field != value) {
+            field = value;
+            dirty |= part;
+        }
+    }
+
+    bool isDirty(Part part) const { return (dirty & part) != 0; }
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_AVATARPOSE_H
@@ -10,6 +10,7 @@ namespace Chatbot {
 VisemeMapper::VisemeMapper()
     : m_loaded(false)
 {
+    m_phonemeTable.fill(kSilenceIndex);
     initializeDefaultMapping();
 }
 
@@ -49,7 +50,7 @@ bool VisemeMapper::loadMapping(const QString& configPath) {
             viseme.mouthHeight = static_cast<float>(visemeData["mouth_height"].toDouble());
             viseme.jawOpen = static_cast<float>(visemeData["jaw_open"].toDouble());
 
-            m_visemes[visemeName] = viseme;
+            addViseme(viseme);
         }
     }
 
@@ -64,43 +65,73 @@ bool VisemeMapper::loadMapping(const QString& configPath) {
         }
     }
 
+    compileMapping();
+
     m_loaded = true;
     spdlog::info("Loaded {} visemes and {} phoneme mappings",
                  m_visemes.size(), m_phonemeToViseme.size());
     return true;
 }
 
-Viseme VisemeMapper::getVisemeForPhoneme(const QString& phoneme) const {
-    // Look up viseme name for this phoneme
-    QString visemeName = m_phonemeToViseme.value(phoneme, "silence");
+const Viseme& VisemeMapper::getVisemeForPhoneme(const QString& phoneme) const {
+    return visemeAt(visemeIndexForPhoneme(phoneme));
+}
+
+const Viseme& VisemeMapper::getVisemeByName(const QString& name) const {
+    // Return silence viseme as fallback
+    return visemeAt(m_visemeIndex.value(name, kSilenceIndex));
+}
 
-    // Return the viseme data
-    return getVisemeByName(visemeName);
+const Viseme& VisemeMapper::getSilenceViseme() const {
+    return visemeAt(kSilenceIndex);
 }
 
-Viseme VisemeMapper::getVisemeByName(const QString& name) const {
-    if (m_visemes.contains(name)) {
-        return m_visemes[name];
+int VisemeMapper::visemeIndexForPhoneme(const QString& phoneme) const {
+    if (phoneme.size() == 1) {
+        return visemeIndexForCodePoint(phoneme.at(0).unicode());
     }
+    return m_phonemeFallback.value(phoneme, kSilenceIndex);
+}
 
-    // Return silence viseme as fallback
-    return getSilenceViseme();
+int VisemeMapper::visemeIndexForCodePoint(char32_t codePoint) const {
+    if (codePoint < kTableSize) {
+        return m_phonemeTable[codePoint];
+    }
+    return m_phonemeFallback.value(QString::fromUcs4(&codePoint, 1), kSilenceIndex);
 }
 
-Viseme VisemeMapper::getSilenceViseme() const {
-    if (m_visemes.contains("silence")) {
-        return m_visemes["silence"];
+void VisemeMapper::addViseme(const Viseme& viseme) {
+    auto it = m_visemeIndex.constFind(viseme.name);
+    if (it != m_visemeIndex.constEnd()) {
+        m_visemes[static_cast<size_t>(it.value())] = viseme;
+        return;
     }
 
-    // Fallback if silence not defined
-    Viseme silence;
-    silence.id = 0;
-    silence.name = "silence";
-    silence.description = "Rest position";
-    silence.mouthWidth = 0.0f;
-    silence.mouthHeight = 0.0f;
-    silence.jawOpen = 0.0f;
-    return silence;
+    m_visemeIndex.insert(viseme.name, static_cast<int>(m_visemes.size()));
+    m_visemes.push_back(viseme);
+}
+
+void VisemeMapper::compileMapping() {
+    m_phonemeTable.fill(kSilenceIndex);
+    m_phonemeFallback.clear();
+
+    for (auto it = m_phonemeToViseme.constBegin(); it != m_phonemeToViseme.constEnd(); ++it) {
+        auto index = m_visemeIndex.constFind(it.value());
+        if (index == m_visemeIndex.constEnd()) {
+            spdlog::warn("Phoneme '{}' maps to unknown viseme '{}', using silence",
+                         it.key().toStdString(), it.value().toStdString());
+            continue;
+        }
+
+        const QString& phoneme = it.key();
+        if (phoneme.size() == 1 && phoneme.at(0).unicode() < kTableSize) {
+            m_phonemeTable[phoneme.at(0).unicode()] = static_cast<qint16>(index.value());
+        } else {
+            m_phonemeFallback.insert(phoneme, index.value());
+        }
+    }
+
+    spdlog::debug("Compiled phoneme table: {} fallback entries", m_phonemeFallback.size());
 }
 
 void VisemeMapper::initializeDefaultMapping() {
@@ -113,9 +144,10 @@ void VisemeMapper::initializeDefaultMapping() {
     silence.mouthHeight = 0.0f;
     silence.jawOpen = 0.0f;
 
-    m_visemes["silence"] = silence;
+    addViseme(silence);
     m_phonemeToViseme[""] = "silence";
     m_phonemeToViseme[" "] = "silence";
+    compileMapping();
 }
 
 } // namespace Chatbot
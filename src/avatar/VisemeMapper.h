@@ -3,7 +3,10 @@
 
 #include <QString>
 #include <QMap>
+#include <QHash>
+#include <array>
 #include <memory>
+#include <vector>
 
 namespace Chatbot {
 
@@ -18,6 +21,12 @@ struct Viseme {
 };
 
 // Manages phoneme-to-viseme mapping
+//
+// The configured mapping is compiled into a dense table indexed by phoneme
+// code point (Piper phonemes are single IPA code points), so lookups on the
+// lip-sync path are an array access returning an index into a contiguous
+// viseme array, without allocating. Multi-character symbols and code points
+// outside the table go through a hash.
 class VisemeMapper {
 public:
     VisemeMapper();
@@ -27,24 +36,42 @@ public:
     bool loadMapping(const QString& configPath);
 
     // Convert phoneme symbol to viseme
-    Viseme getVisemeForPhoneme(const QString& phoneme) const;
+    const Viseme& getVisemeForPhoneme(const QString& phoneme) const;
 
     // Get viseme by name
-    Viseme getVisemeByName(const QString& name) const;
+    const Viseme& getVisemeByName(const QString& name) const;
 
     // Check if mapping is loaded
     bool isLoaded() const { return m_loaded; }
 
     // Get silence/rest viseme
-    Viseme getSilenceViseme() const;
+    const Viseme& getSilenceViseme() const;
+
+    // Index-based access (indices stay valid until the next loadMapping())
+    int visemeIndexForPhoneme(const QString& phoneme) const;
+    int visemeIndexForCodePoint(char32_t codePoint) const;
+    const Viseme& visemeAt(int index) const { return m_visemes[static_cast<size_t>(index)]; }
+    int visemeCount() const { return static_cast<int>(m_visemes.size()); }
+
+    static constexpr int kSilenceIndex = 0;
 
 private:
     void initializeDefaultMapping();
+    void addViseme(const Viseme& viseme);
+    void compileMapping();
 
 private:
+    // Code points below this (Latin, IPA, spacing modifiers) are table lookups
+    static constexpr char32_t kTableSize = 0x400;
+
     bool m_loaded;
-    QMap<QString, Viseme> m_visemes;           // Viseme name -> Viseme data
+    std::vector<Viseme> m_visemes;             // Viseme data, silence at kSilenceIndex
+    QHash<QString, int> m_visemeIndex;         // Viseme name -> index in m_visemes
     QMap<QString, QString> m_phonemeToViseme;  // Phoneme symbol -> Viseme name
+
+    // Compiled from m_phonemeToViseme
+    std::array<qint16, kTableSize> m_phonemeTable;  // Code point -> viseme index
+    QHash<QString, int> m_phonemeFallback;          // Other symbols -> viseme index
 };
 
 } // namespace Chatbot
@@ -0,0 +1,53 @@
+#include "avatar/VisemeTrack.h"
+#include <spdlog/spdlog.h>
+
+namespace Chatbot {
+
+namespace {
+// Same-viseme phonemes closer than this are merged across the gap (seconds)
+constexpr double kMergeGap = 0.02;
+}
+
+VisemeTrack::VisemeTrack()
+    : m_lastEndTime(0.0)
+{
+}
+
+void VisemeTrack::append(const PhonemeTimeline& timeline, double offset, const VisemeMapper& mapper) {
+    size_t keysBefore = m_visemes.size();
+
+    for (const Phoneme& phoneme : timeline.phonemes) {
+        double start = offset + phoneme.startTime;
+        double end = start + phoneme.duration;
+
+        int viseme = phoneme.symbol.isEmpty()
+            ? VisemeMapper::kSilenceIndex
+            : mapper.visemeIndexForPhoneme(phoneme.symbol);
+
+        // Coarticulation: the mouth holds its shape through a run of phonemes
+        // that share it, so the run becomes a single key
+        if (!m_visemes.empty() && m_visemes.back() == viseme && start - m_lastEndTime <= kMergeGap) {
+            m_cursor.extendLast(end);
+        } else {
+            m_cursor.append(start, end);
+            m_visemes.push_back(viseme);
+        }
+        m_lastEndTime = end;
+    }
+
+    spdlog::debug("Viseme track: {} phonemes -> {} keys",
+                  timeline.phonemes.size(), m_visemes.size() - keysBefore);
+}
+
+void VisemeTrack::clear() {
+    m_cursor.clear();
+    m_visemes.clear();
+    m_lastEndTime = 0.0;
+}
+
+int VisemeTrack::sample(double time) {
+    int key = m_cursor.seek(time);
+    return key < 0 ? VisemeMapper::kSilenceIndex : m_visemes[static_cast<size_t>(key)];
+}
+
+} // namespace Chatbot
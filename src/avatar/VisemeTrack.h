@@ -0,0 +1,47 @@
+#ifndef CHATBOT_VISEMETRACK_H
+#define CHATBOT_VISEMETRACK_H
+
+#include "avatar/VisemeMapper.h"
+#include "tts/PhonemeTimeline.h"
+#include "tts/TimelineCursor.h"
+#include <vector>
+
+namespace Chatbot {
+
+/**
+ * VisemeTrack is a phoneme timeline resolved to visemes ahead of playback.
+ * Each key holds a viseme index (into the VisemeMapper) with start and end
+ * times; consecutive phonemes with the same mouth shape collapse into one
+ * key. Sampling during playback is a cursor lookup, with no mapping or
+ * string work.
+ */
+class VisemeTrack {
+public:
+    VisemeTrack();
+    ~VisemeTrack() = default;
+
+    // Resolve an utterance's phonemes (times relative to offset, in seconds)
+    // and append them; utterances must be appended in playback order
+    void append(const PhonemeTimeline& timeline, double offset, const VisemeMapper& mapper);
+
+    void clear();
+
+    // Viseme index at time (VisemeMapper::kSilenceIndex between keys)
+    int sample(double time);
+
+    // Keys by index, in time order
+    size_t keyCount() const { return m_visemes.size(); }
+    double keyStart(size_t key) const { return m_cursor.startTime(key); }
+    double keyEnd(size_t key) const { return m_cursor.endTime(key); }
+    int keyViseme(size_t key) const { return m_visemes[key]; }
+    bool isEmpty() const { return m_visemes.empty(); }
+
+private:
+    TimelineCursor m_cursor;    // Key times
+    std::vector<int> m_visemes; // Viseme index per key
+    double m_lastEndTime;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_VISEMETRACK_H
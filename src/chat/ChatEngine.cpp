@@ -1,10 +1,11 @@
 #include "chat/ChatEngine.h"
-#include "chat/ConversationHistory.h"
+#include "chat/ChatSession.h"
+#include "chat/ResponseCache.h"
+#include "chat/SessionPool.h"
 #include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
-#include <QFuture>
-#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
 
 using json = nlohmann::json;
 
@@ -14,19 +15,41 @@ ChatEngine::ChatEngine(QObject *parent)
     : QObject(parent)
     , m_ollamaUrl("http://localhost:11434")
     , m_model("llama3.2:3b")
-    , m_systemPrompt("You are a helpful, friendly assistant.")
-    , m_isProcessing(false)
-    , m_history(std::make_unique<ConversationHistory>())
+    , m_keepAlive("30m")          // Ollama unloads after 5 minutes by default
+    , m_streamingEnabled(true)
+    , m_apiMode(ApiMode::Chat)
+    , m_contextTokenBudget(2048)  // Ollama's default context window
+    , m_summaryThreshold(1024)    // Half the default context budget
+    , m_defaultSession(nullptr)
+    , m_scheduler(new RequestScheduler(this))
+    , m_responseCache(std::make_unique<ResponseCache>())
+    , m_httpSessions(std::make_unique<SessionPool>())
 {
+    // The default session's signals are the engine's own
+    m_defaultSession = session(kDefaultSession);
+    connect(m_defaultSession, &ChatSession::partialResponseReceived, this, &ChatEngine::partialResponseReceived);
+    connect(m_defaultSession, &ChatSession::responseReceived, this, &ChatEngine::responseReceived);
+    connect(m_defaultSession, &ChatSession::errorOccurred, this, &ChatEngine::errorOccurred);
+    connect(m_defaultSession, &ChatSession::processingStarted, this, &ChatEngine::processingStarted);
+    connect(m_defaultSession, &ChatSession::processingFinished, this, &ChatEngine::processingFinished);
+    connect(m_defaultSession, &ChatSession::requestCancelled, this, &ChatEngine::requestCancelled);
+
     spdlog::info("ChatEngine initialized with model: {}", m_model.toStdString());
 }
 
 ChatEngine::~ChatEngine() {
+    // Abort everything in flight so blocked workers return promptly
+    m_shutdown.cancel();
+    m_chatSessions.clear();
+
+    // Running jobs use this engine and its HTTP sessions
+    m_scheduler->waitForRunningJobs();
     spdlog::info("ChatEngine destroyed");
 }
 
 void ChatEngine::setOllamaUrl(const QString& url) {
     m_ollamaUrl = url;
+    m_httpSessions->clear();
     spdlog::info("Ollama URL set to: {}", url.toStdString());
 }
 
@@ -35,130 +58,300 @@ void ChatEngine::setModel(const QString& model) {
     spdlog::info("Model changed to: {}", model.toStdString());
 }
 
+void ChatEngine::setStreamingEnabled(bool enabled) {
+    m_streamingEnabled = enabled;
+    spdlog::info("Streaming responses {}", enabled ? "enabled" : "disabled");
+}
+
+void ChatEngine::setContextTokenBudget(int tokens) {
+    m_contextTokenBudget = tokens;
+    for (auto& entry : m_chatSessions) {
+        entry.second->setContextTokenBudget(tokens);
+    }
+}
+
+void ChatEngine::setApiMode(ApiMode mode) {
+    m_apiMode = mode;
+    spdlog::info("Using Ollama {} endpoint", mode == ApiMode::Chat ? "/api/chat" : "/api/generate");
+}
+
+void ChatEngine::setSummaryThreshold(int tokens) {
+    m_summaryThreshold = std::max(0, tokens);
+    spdlog::info("History summary threshold set to {} tokens", m_summaryThreshold);
+}
+
+void ChatEngine::setTimeouts(int connectTimeoutMs, int readTimeoutSec) {
+    m_httpSessions->setTimeouts(std::chrono::milliseconds(connectTimeoutMs), std::chrono::seconds(readTimeoutSec));
+}
+
+void ChatEngine::setMaxConcurrentRequests(int count) {
+    m_scheduler->setMaxInFlight(count);
+}
+
+void ChatEngine::setMaxQueuedPerSession(int count) {
+    m_scheduler->setMaxQueuedPerSession(count);
+}
+
+void ChatEngine::setKeepAlive(const QString& duration) {
+    m_keepAlive = duration;
+    spdlog::info("Model keep-alive set to: {}", duration.isEmpty() ? "server default" : duration.toStdString());
+}
+
 void ChatEngine::setSystemPrompt(const QString& prompt) {
-    m_systemPrompt = prompt;
-    spdlog::info("System prompt updated");
+    m_defaultSession->setSystemPrompt(prompt);
+}
+
+void ChatEngine::sendMessage(const QString& message) {
+    m_defaultSession->sendMessage(message);
+}
+
+void ChatEngine::cancelRequest() {
+    m_defaultSession->cancelRequest();
 }
 
 void ChatEngine::clearHistory() {
-    m_history->clear();
-    spdlog::info("Conversation history cleared");
+    m_defaultSession->clearHistory();
 }
 
-void ChatEngine::sendMessage(const QString& message) {
-    if (m_isProcessing) {
-        spdlog::warn("Already processing a message, ignoring new request");
-        emit errorOccurred("Already processing a message. Please wait.");
-        return;
-    }
+bool ChatEngine::isProcessing() const {
+    return m_defaultSession->isProcessing();
+}
 
-    if (message.trimmed().isEmpty()) {
-        spdlog::warn("Empty message received");
-        emit errorOccurred("Message cannot be empty");
-        return;
+void ChatEngine::preloadModel() {
+    // Ollama only loads the model when given no prompt at all
+    json body;
+    if (m_apiMode == ApiMode::Chat) {
+        body["messages"] = json::array();
+    } else {
+        body["prompt"] = "";
     }
 
-    spdlog::info("Processing user message: {}", message.toStdString());
-    processMessageAsync(message);
+    spdlog::info("Preloading model {}", m_model.toStdString());
+    submit(createRequest(kDefaultSession, std::move(body), false), RequestPriority::Background,
+           [model = m_model](const QString&) {
+               // Failures were already logged by callOllamaAPI
+               spdlog::debug("Preload request for {} finished", model.toStdString());
+           });
 }
 
-void ChatEngine::processMessageAsync(const QString& message) {
-    m_isProcessing = true;
-    emit processingStarted();
+ChatSession* ChatEngine::session(const QString& id) {
+    auto it = m_chatSessions.find(id);
+    if (it != m_chatSessions.end()) {
+        return it->second.get();
+    }
 
-    // Add user message to history
-    m_history->addUserMessage(message);
+    auto created = std::make_unique<ChatSession>(id, this);
+    created->setContextTokenBudget(m_contextTokenBudget);
+    ChatSession* session = created.get();
+    m_chatSessions.emplace(id, std::move(created));
+    spdlog::info("Chat session '{}' created ({} sessions)", id.toStdString(), m_chatSessions.size());
+    return session;
+}
 
-    // Run API call in a separate thread
-    QFuture<QString> future = QtConcurrent::run([this, message]() {
-        return callOllamaAPI(message);
-    });
+ChatSession* ChatEngine::findSession(const QString& id) const {
+    auto it = m_chatSessions.find(id);
+    return it != m_chatSessions.end() ? it->second.get() : nullptr;
+}
 
-    // Watch for completion
-    QFutureWatcher<QString>* watcher = new QFutureWatcher<QString>(this);
-    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher]() {
-        QString response = watcher->result();
+void ChatEngine::removeSession(const QString& id) {
+    if (id == kDefaultSession) {
+        spdlog::warn("The default chat session cannot be removed");
+        return;
+    }
+    if (m_chatSessions.erase(id) > 0) {
+        spdlog::info("Chat session '{}' removed", id.toStdString());
+    }
+}
 
-        if (response.isEmpty()) {
-            spdlog::error("Empty response from Ollama API");
-            emit errorOccurred("Failed to get response from LLM");
-        } else {
-            // Add bot response to history
-            m_history->addBotMessage(response);
-            spdlog::info("Response received from LLM");
-            emit responseReceived(response);
-        }
+QStringList ChatEngine::sessionIds() const {
+    QStringList ids;
+    for (const auto& entry : m_chatSessions) {
+        ids.append(entry.first);
+    }
+    return ids;
+}
 
-        m_isProcessing = false;
-        emit processingFinished();
-        watcher->deleteLater();
-    });
+ChatRequest ChatEngine::createRequest(const QString& sessionId, json body, bool stream) const {
+    body["model"] = m_model.toStdString();
+    body["stream"] = stream;
+    if (!m_keepAlive.isEmpty()) {
+        body["keep_alive"] = m_keepAlive.toStdString();
+    }
+
+    ChatRequest request;
+    request.sessionId = sessionId;
+    request.url = (m_ollamaUrl + (m_apiMode == ApiMode::Chat ? "/api/chat" : "/api/generate")).toStdString();
+    request.body = body.dump();
+    request.stream = stream;
+    return request;
+}
 
-    watcher->setFuture(future);
+bool ChatEngine::submit(ChatRequest request, RequestPriority priority, RequestScheduler::Completion done) {
+    QString sessionId = request.sessionId;
+    CancellationToken token = request.cancellation;
+    return m_scheduler->submit(sessionId, priority, token, [this, request = std::move(request)]() {
+        return callOllamaAPI(request);
+    }, std::move(done));
 }
 
-QString ChatEngine::callOllamaAPI(const QString& prompt) {
+QString ChatEngine::callOllamaAPI(const ChatRequest& request) {
     try {
-        // Build request URL
-        QString apiUrl = m_ollamaUrl + "/api/generate";
-
-        // Build conversation history into the prompt
-        std::string fullPrompt;
-        auto messages = m_history->getMessages();
-
-        // Add previous conversation (excluding the current prompt which is already in history)
-        if (messages.size() > 1) {
-            fullPrompt += "Previous conversation:\n";
-            for (size_t i = 0; i < messages.size() - 1; i++) {
-                const auto& msg = messages[i];
-                if (msg.role == "user") {
-                    fullPrompt += "User: " + msg.content + "\n";
-                } else {
-                    fullPrompt += "Assistant: " + msg.content + "\n";
+        spdlog::debug("Sending request to Ollama: {}", request.url);
+
+        // Reuse a pooled session so the connection to Ollama stays open
+        SessionPool::Lease session = m_httpSessions->acquire();
+        auto cancelled = [&request, shutdown = m_shutdown]() {
+            return request.cancellation.isCancelled() || shutdown.isCancelled();
+        };
+
+        // Ollama streams one JSON object per line; chunks from curl may
+        // split or join lines, so buffer until a newline is seen.
+        std::string received;
+        std::string llmResponse;
+        bool streamOk = true;
+        bool streamDone = false;
+
+        session->SetUrl(cpr::Url{request.url});
+        session->SetHeader(cpr::Header{{"Content-Type", "application/json"}});
+        session->SetBody(cpr::Body{request.body});
+        session->SetWriteCallback(cpr::WriteCallback{[&](auto data, intptr_t) -> bool {
+            if (cancelled()) {
+                return false;  // Aborts the transfer
+            }
+            received.append(data.data(), data.size());
+            if (!request.stream) {
+                return true;
+            }
+            size_t newline;
+            while ((newline = received.find('\n')) != std::string::npos) {
+                std::string line = received.substr(0, newline);
+                received.erase(0, newline + 1);
+                if (!handleStreamLine(line, request, llmResponse, streamDone)) {
+                    streamOk = false;
                 }
             }
-            fullPrompt += "\nCurrent question:\n";
+            return true;
+        }});
+        // Called about once a second even while waiting for the first byte
+        session->SetProgressCallback(cpr::ProgressCallback{
+            [&](cpr::cpr_off_t, cpr::cpr_off_t, cpr::cpr_off_t, cpr::cpr_off_t, intptr_t) -> bool {
+                return !cancelled();
+            }});
+
+        // Make HTTP POST request
+        cpr::Response response = session->Post();
+
+        if (cancelled()) {
+            return QString();
         }
-        fullPrompt += prompt.toStdString();
 
-        // Build JSON request
-        json requestJson;
-        requestJson["model"] = m_model.toStdString();
-        requestJson["prompt"] = fullPrompt;
-        requestJson["system"] = m_systemPrompt.toStdString();
-        requestJson["stream"] = false;
+        if (request.stream) {
+            // Final line may arrive without a trailing newline
+            if (!received.empty() && !handleStreamLine(received, request, llmResponse, streamDone)) {
+                streamOk = false;
+            }
 
-        spdlog::debug("Sending request to Ollama: {}", apiUrl.toStdString());
+            if (response.status_code != 200 || !streamOk) {
+                spdlog::error("Ollama API error: HTTP {} {}", response.status_code, response.error.message);
+                return QString();
+            }
 
-        // Make HTTP POST request
-        cpr::Response response = cpr::Post(
-            cpr::Url{apiUrl.toStdString()},
-            cpr::Header{{"Content-Type", "application/json"}},
-            cpr::Body{requestJson.dump()}
-        );
+            // A connection closed mid-generation still ends with HTTP 200;
+            // only the final chunk says the reply is complete
+            if (!streamDone) {
+                spdlog::error("Ollama stream ended before the final chunk ({} chars received)", llmResponse.size());
+                return QString();
+            }
+
+            return QString::fromStdString(llmResponse);
+        }
 
         // Check response
         if (response.status_code != 200) {
-            spdlog::error("Ollama API error: HTTP {}", response.status_code);
-            spdlog::error("Response: {}", response.text);
+            spdlog::error("Ollama API error: HTTP {} {}", response.status_code, response.error.message);
+            spdlog::error("Response: {}", received);
             return QString();
         }
 
         // Parse JSON response
-        json responseJson = json::parse(response.text);
+        json responseJson = json::parse(received);
+        logPromptStats(responseJson, request);
 
-        if (responseJson.contains("response")) {
-            std::string llmResponse = responseJson["response"];
-            return QString::fromStdString(llmResponse);
-        } else {
-            spdlog::error("No 'response' field in Ollama API response");
-            return QString();
+        // /api/generate answers in "response", /api/chat in "message.content"
+        if (responseJson.contains("response") && responseJson["response"].is_string()) {
+            return QString::fromStdString(responseJson["response"].get<std::string>());
+        }
+        if (responseJson.contains("message") && responseJson["message"].contains("content") && responseJson["message"]["content"].is_string()) {
+            return QString::fromStdString(responseJson["message"]["content"].get<std::string>());
         }
 
+        spdlog::error("No response text in Ollama API response");
+        return QString();
+
     } catch (const std::exception& e) {
         spdlog::error("Exception in callOllamaAPI: {}", e.what());
         return QString();
     }
 }
 
+bool ChatEngine::handleStreamLine(const std::string& line, const ChatRequest& request,
+                                  std::string& fullResponse, bool& done) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+        return true;
+    }
+
+    json chunk = json::parse(line, nullptr, false);
+    if (chunk.is_discarded()) {
+        spdlog::warn("Skipping malformed stream chunk: {}", line);
+        return true;
+    }
+
+    if (chunk.contains("error")) {
+        spdlog::error("Ollama stream error: {}", chunk["error"].dump());
+        return false;
+    }
+
+    if (chunk.value("done", false)) {
+        done = true;
+        logPromptStats(chunk, request);
+    }
+
+    // /api/generate streams "response", /api/chat streams "message.content"
+    std::string delta;
+    if (chunk.contains("response") && chunk["response"].is_string()) {
+        delta = chunk["response"].get<std::string>();
+    } else if (chunk.contains("message") && chunk["message"].contains("content") && chunk["message"]["content"].is_string()) {
+        delta = chunk["message"]["content"].get<std::string>();
+    }
+
+    if (!delta.empty()) {
+        fullResponse += delta;
+
+        // Called on the worker thread; deliver on the engine's thread, unless
+        // the reply was cancelled in the meantime
+        QString qDelta = QString::fromStdString(delta);
+        QMetaObject::invokeMethod(this, [this, qDelta, id = request.sessionId, token = request.cancellation]() {
+            ChatSession* session = findSession(id);
+            if (session && !token.isCancelled()) {
+                emit session->partialResponseReceived(qDelta);
+            }
+        }, Qt::QueuedConnection);
+    }
+
+    return true;
+}
+
+void ChatEngine::logPromptStats(const json& response, const ChatRequest& request) {
+    if (!response.contains("prompt_eval_count")) {
+        // Ollama leaves this out when the whole prompt came from its cache
+        spdlog::debug("Prompt fully cached (~{} tokens of context)", request.estimatedTokens);
+        return;
+    }
+
+    int evaluated = response.value("prompt_eval_count", 0);
+    double ms = response.value("prompt_eval_duration", 0.0) / 1e6;
+    spdlog::debug("Prompt evaluated {} tokens in {:.1f} ms (~{} tokens of context)",
+                  evaluated, ms, request.estimatedTokens);
+}
+
 } // namespace Chatbot
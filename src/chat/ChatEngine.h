@@ -1,56 +1,145 @@
 #ifndef CHATBOT_CHATENGINE_H
 #define CHATBOT_CHATENGINE_H
 
+#include "chat/RequestScheduler.h"
+#include "core/CancellationToken.h"
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QThread>
+#include <nlohmann/json.hpp>
+#include <map>
 #include <memory>
+#include <string>
 
 namespace Chatbot {
 
-class ConversationHistory;
+class ChatSession;
+class ResponseCache;
+class SessionPool;
+
+// Ollama endpoint used for requests
+enum class ApiMode {
+    Generate,  // /api/generate with a flattened text prompt
+    Chat       // /api/chat with a messages array (stable prefix, KV cache reuse)
+};
+
+// Everything a worker thread needs for one request, prepared beforehand
+struct ChatRequest {
+    QString sessionId;  // Receives the streamed chunks
+    std::string url;
+    std::string body;
+    bool stream = false;
+    int estimatedTokens = 0;  // Context size, for prompt cache statistics
+    CancellationToken cancellation;
+};
 
 /**
- * ChatEngine handles communication with the LLM (Ollama API)
- * and manages conversation state.
+ * ChatEngine handles communication with the LLM (Ollama API) for any
+ * number of chat sessions. It holds the model configuration, the HTTP
+ * connections and the scheduler that bounds concurrent requests; each
+ * ChatSession holds one conversation.
+ *
+ * The "default" session always exists; the single-conversation methods
+ * and signals below operate on it.
  */
 class ChatEngine : public QObject {
     Q_OBJECT
 
 public:
+    static constexpr const char* kDefaultSession = "default";
+
     explicit ChatEngine(QObject *parent = nullptr);
     ~ChatEngine() override;
 
-    // Configuration
+    // Configuration (all sessions)
     void setOllamaUrl(const QString& url);
     void setModel(const QString& model);
-    void setSystemPrompt(const QString& prompt);
+    void setStreamingEnabled(bool enabled);  // Stream tokens as NDJSON chunks
+    void setContextTokenBudget(int tokens);  // System prompt + prompt (0 = unlimited)
+    void setApiMode(ApiMode mode);
+    void setSummaryThreshold(int tokens);    // Summarize older messages past this (0 = never)
+    void setTimeouts(int connectTimeoutMs, int readTimeoutSec);  // Read = longest stall
+    void setMaxConcurrentRequests(int count);
+    void setMaxQueuedPerSession(int count);
+    void setKeepAlive(const QString& duration);  // How long Ollama keeps the model loaded ("" = server default)
 
-    // Chat operations
-    void sendMessage(const QString& message);
+    // Default session
+    void setSystemPrompt(const QString& prompt);
+    void sendMessage(const QString& message);  // Interrupts the reply in progress, if any
+    void cancelRequest();                      // Abandon the reply in progress, if any
     void clearHistory();
+    bool isProcessing() const;
+    ChatSession* defaultSession() const { return m_defaultSession; }
+
+    // Have Ollama load the model now rather than on the first message
+    // (a request without any prompt tokens, at background priority)
+    void preloadModel();
+
+    // Sessions
+    ChatSession* session(const QString& id);  // Created on first use
+    ChatSession* findSession(const QString& id) const;
+    void removeSession(const QString& id);    // Cancels its requests
+    QStringList sessionIds() const;
+    RequestScheduler* scheduler() const { return m_scheduler; }
+
+    // Replies to repeated prompts, shared by all sessions
+    ResponseCache* responseCache() const { return m_responseCache.get(); }
 
     // Status
-    bool isProcessing() const { return m_isProcessing; }
     QString currentModel() const { return m_model; }
+    bool isStreamingEnabled() const { return m_streamingEnabled; }
+    ApiMode apiMode() const { return m_apiMode; }
+    int summaryThreshold() const { return m_summaryThreshold; }
 
 signals:
+    // Default session: emitted per streamed chunk (streaming mode only), before responseReceived
+    void partialResponseReceived(const QString& delta);
     void responseReceived(const QString& response);
     void errorOccurred(const QString& error);
     void processingStarted();
     void processingFinished();
 
+    // Emitted when the reply in progress is abandoned (cancelRequest or a new
+    // message), before processingFinished; no further chunks follow
+    void requestCancelled();
+
 private:
-    void processMessageAsync(const QString& message);
-    QString callOllamaAPI(const QString& prompt);
+    friend class ChatSession;
+
+    // Add model and stream flag to a request body and address it to the current endpoint
+    ChatRequest createRequest(const QString& sessionId, nlohmann::json body, bool stream) const;
+
+    // Queue a request; done runs on this thread with the reply (empty on
+    // failure or cancellation). Returns false if the session's queue is full.
+    bool submit(ChatRequest request, RequestPriority priority, RequestScheduler::Completion done);
+
+    QString callOllamaAPI(const ChatRequest& request);
+
+    // Parse one NDJSON line from a streamed response, appending its delta and
+    // setting done on the final chunk. Returns false if the line reports an error.
+    bool handleStreamLine(const std::string& line, const ChatRequest& request,
+                          std::string& fullResponse, bool& done);
+
+    // Log how much of the prompt Ollama had to evaluate (the rest came from its cache)
+    static void logPromptStats(const nlohmann::json& response, const ChatRequest& request);
 
 private:
     QString m_ollamaUrl;
     QString m_model;
-    QString m_systemPrompt;
-    bool m_isProcessing;
+    QString m_keepAlive;
+    bool m_streamingEnabled;
+    ApiMode m_apiMode;
+    int m_contextTokenBudget;
+    int m_summaryThreshold;
+
+    std::map<QString, std::unique_ptr<ChatSession>> m_chatSessions;
+    ChatSession* m_defaultSession;
+    RequestScheduler* m_scheduler;  // Owned by this object
 
-    std::unique_ptr<ConversationHistory> m_history;
+    CancellationToken m_shutdown;  // Aborts every request when the engine is destroyed
+    std::unique_ptr<ResponseCache> m_responseCache;
+    std::unique_ptr<SessionPool> m_httpSessions;
     std::unique_ptr<QThread> m_workerThread;
 };
 
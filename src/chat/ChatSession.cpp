@@ -0,0 +1,281 @@
+#include "chat/ChatSession.h"
+#include "chat/ChatEngine.h"
+#include "chat/ConversationHistory.h"
+#include "chat/ContextBuilder.h"
+#include "chat/ResponseCache.h"
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace Chatbot {
+
+namespace {
+// Most recent messages always sent verbatim, never summarized
+constexpr std::ptrdiff_t kRecentMessagesKept = 4;
+
+// Messages before the user message that must match for a cached reply
+constexpr std::ptrdiff_t kCacheContextMessages = 2;
+
+const char* const kSummaryInstructions =
+    "You maintain a running summary of a conversation between a user and an assistant. "
+    "Merge the existing summary (if any) with the new messages into one concise summary. "
+    "Keep names, facts, preferences and open questions. Reply with the summary only.";
+}
+
+ChatSession::ChatSession(const QString& id, ChatEngine* engine)
+    : QObject(nullptr)
+    , m_id(id)
+    , m_engine(engine)
+    , m_systemPrompt("You are a helpful, friendly assistant.")
+    , m_isProcessing(false)
+    , m_isSummarizing(false)
+    , m_historyGeneration(0)
+    , m_history(std::make_unique<ConversationHistory>())
+    , m_contextBuilder(std::make_unique<ContextBuilder>())
+{
+}
+
+ChatSession::~ChatSession() {
+    // Let workers still blocked on Ollama return promptly
+    m_requestToken.cancel();
+    m_summaryToken.cancel();
+}
+
+void ChatSession::setSystemPrompt(const QString& prompt) {
+    m_systemPrompt = prompt;
+    spdlog::info("System prompt updated for session '{}'", m_id.toStdString());
+}
+
+void ChatSession::setPersonality(const QString& name) {
+    m_personality = name;
+}
+
+void ChatSession::setContextTokenBudget(int tokens) {
+    m_contextBuilder->setTokenBudget(tokens);
+}
+
+void ChatSession::clearHistory() {
+    m_history->clear();
+    m_contextBuilder->reset();
+    ++m_historyGeneration;
+    m_summaryToken.cancel();
+    spdlog::info("Conversation history cleared");
+}
+
+void ChatSession::sendMessage(const QString& message) {
+    if (message.trimmed().isEmpty()) {
+        spdlog::warn("Empty message received");
+        emit errorOccurred("Message cannot be empty");
+        return;
+    }
+
+    // Barge-in: nobody is waiting for the old reply any more
+    if (m_isProcessing) {
+        spdlog::info("New message while processing, interrupting the current reply");
+        cancelRequest();
+    }
+
+    // Backpressure: refuse before the message becomes part of the history
+    if (!m_engine->scheduler()->canAccept(m_id)) {
+        emit errorOccurred("Too many requests waiting. Please try again shortly.");
+        return;
+    }
+
+    spdlog::info("Processing user message: {}", message.toStdString());
+    m_isProcessing = true;
+    emit processingStarted();
+
+    // Add user message to history
+    m_history->addUserMessage(message);
+
+    // Repeated prompts are answered without a generation
+    m_cacheKey = responseCacheKey();
+    if (!m_cacheKey.empty()) {
+        if (std::optional<std::string> cached = m_engine->responseCache()->lookup(m_cacheKey)) {
+            spdlog::info("Answering from the response cache");
+            m_cacheKey.clear();  // Keep the entry's original age
+            m_requestToken = CancellationToken();
+
+            // Delivered from the event loop like any other reply, so it can still be cancelled
+            QMetaObject::invokeMethod(this, [this, reply = QString::fromStdString(*cached), token = m_requestToken]() {
+                onReply(reply, token);
+            }, Qt::QueuedConnection);
+            return;
+        }
+    }
+
+    // Serialize the request here; the worker thread never touches the history
+    ChatRequest request = buildRequest();
+    m_requestToken = request.cancellation;
+
+    m_engine->submit(std::move(request), RequestPriority::Interactive,
+                     [engine = m_engine, id = m_id, token = m_requestToken](const QString& response) {
+                         // The session may have been removed while the request ran
+                         if (ChatSession* session = engine->findSession(id)) {
+                             session->onReply(response, token);
+                         }
+                     });
+}
+
+void ChatSession::cancelRequest() {
+    if (!m_isProcessing) {
+        return;
+    }
+
+    // The worker aborts the transfer within about a second; its result is
+    // ignored, so the session is free for the next message right away
+    m_requestToken.cancel();
+    m_isProcessing = false;
+    spdlog::info("Request cancelled");
+
+    emit requestCancelled();
+    emit processingFinished();
+}
+
+void ChatSession::onReply(const QString& response, const CancellationToken& token) {
+    if (token.isCancelled()) {
+        spdlog::debug("Discarding cancelled reply");
+        return;  // cancelRequest() already finished this turn
+    }
+
+    if (response.isEmpty()) {
+        spdlog::error("Empty response from Ollama API");
+        emit errorOccurred("Failed to get response from LLM");
+    } else {
+        // Add bot response to history
+        m_history->addBotMessage(response);
+        spdlog::info("Response received from LLM");
+
+        if (!m_cacheKey.empty()) {
+            m_engine->responseCache()->insert(m_cacheKey, response.toStdString());
+            m_cacheKey.clear();
+        }
+        emit responseReceived(response);
+    }
+
+    m_isProcessing = false;
+    emit processingFinished();
+
+    maybeSummarize();
+}
+
+std::string ChatSession::responseCacheKey() const {
+    if (!m_engine->responseCache()->isEnabled() || m_history->isEmpty()) {
+        return {};
+    }
+
+    // The user message just added, and the exchange it follows
+    auto last = m_history->end() - 1;
+    auto first = last - std::min(kCacheContextMessages, last - m_history->begin());
+
+    std::vector<std::string> context;
+    for (auto it = first; it != last; ++it) {
+        context.push_back(it->role + ": " + it->content);
+    }
+
+    return ResponseCache::makeKey(m_engine->currentModel().toStdString(), m_personality.toStdString(),
+                                  m_systemPrompt.toStdString(), context, last->content);
+}
+
+ChatRequest ChatSession::buildRequest() {
+    std::string systemPrompt = m_systemPrompt.toStdString();
+    ContextWindow window = m_contextBuilder->select(*m_history, systemPrompt);
+
+    json body;
+    if (m_engine->apiMode() == ApiMode::Chat) {
+        body["messages"] = m_contextBuilder->buildMessages(*m_history, window, systemPrompt);
+    } else {
+        body["prompt"] = m_contextBuilder->buildPrompt(*m_history, window);
+        body["system"] = systemPrompt;
+    }
+
+    ChatRequest request = m_engine->createRequest(m_id, std::move(body), m_engine->isStreamingEnabled());
+    request.estimatedTokens = window.estimatedTokens;
+    return request;
+}
+
+void ChatSession::maybeSummarize() {
+    int threshold = m_engine->summaryThreshold();
+    if (threshold == 0 || m_isSummarizing) {
+        return;
+    }
+
+    // Messages not yet covered by the summary, oldest first
+    auto first = m_history->begin();
+    while (first != m_history->end() && first->sequence <= m_history->summarizedThrough()) {
+        ++first;
+    }
+
+    int tokens = 0;
+    for (auto it = first; it != m_history->end(); ++it) {
+        tokens += it->tokenEstimate;
+    }
+    if (tokens <= threshold) {
+        return;
+    }
+
+    // Condense everything except the latest exchanges
+    auto last = m_history->end() - std::min(kRecentMessagesKept, m_history->end() - first);
+    if (first == last) {
+        return;
+    }
+
+    std::string transcript;
+    if (m_history->hasSummary()) {
+        transcript += "Existing summary:\n" + m_history->summary().content + "\n\n";
+    }
+    transcript += "New messages:\n";
+    for (auto it = first; it != last; ++it) {
+        transcript += it->role == "user" ? "User: " : "Assistant: ";
+        transcript += it->content;
+        transcript += '\n';
+    }
+
+    quint64 through = (last - 1)->sequence;
+    quint64 generation = m_historyGeneration;
+
+    json body;
+    if (m_engine->apiMode() == ApiMode::Chat) {
+        body["messages"] = json::array({
+            {{"role", "system"}, {"content", kSummaryInstructions}},
+            {{"role", "user"}, {"content", transcript}}
+        });
+    } else {
+        body["prompt"] = transcript;
+        body["system"] = kSummaryInstructions;
+    }
+    ChatRequest request = m_engine->createRequest(m_id, std::move(body), false);
+    request.estimatedTokens = ContextBuilder::estimateTokens(transcript);
+    m_summaryToken = request.cancellation;
+
+    // Background priority: waits while any session has a reply queued
+    bool queued = m_engine->submit(std::move(request), RequestPriority::Background,
+                                   [engine = m_engine, id = m_id, through, generation](const QString& result) {
+        ChatSession* session = engine->findSession(id);
+        if (!session) {
+            return;
+        }
+
+        QString summary = result.trimmed();
+        session->m_isSummarizing = false;
+
+        if (generation != session->m_historyGeneration) {
+            spdlog::debug("History cleared during summarization, discarding summary");
+        } else if (summary.isEmpty()) {
+            spdlog::warn("Summarization failed, will retry after the next turn");
+        } else {
+            session->m_history->setSummary(summary.toStdString(), through);
+        }
+    });
+
+    if (queued) {
+        m_isSummarizing = true;
+        spdlog::info("Summarizing {} messages (~{} tokens unsummarized)", last - first, tokens);
+    }
+}
+
+} // namespace Chatbot
@@ -0,0 +1,95 @@
+#ifndef CHATBOT_CHATSESSION_H
+#define CHATBOT_CHATSESSION_H
+
+#include "core/CancellationToken.h"
+#include <QObject>
+#include <QString>
+#include <memory>
+#include <string>
+
+namespace Chatbot {
+
+class ChatEngine;
+class ConversationHistory;
+class ContextBuilder;
+struct ChatRequest;
+
+/**
+ * ChatSession is one conversation: its own history, system prompt and
+ * personality, and at most one reply in progress. Sessions are created by
+ * ChatEngine, which holds the model configuration and the HTTP connections
+ * and schedules the requests of all sessions.
+ */
+class ChatSession : public QObject {
+    Q_OBJECT
+
+public:
+    ChatSession(const QString& id, ChatEngine* engine);
+    ~ChatSession() override;
+
+    // Delete copy constructor and assignment operator
+    ChatSession(const ChatSession&) = delete;
+    ChatSession& operator=(const ChatSession&) = delete;
+
+    // Configuration
+    void setSystemPrompt(const QString& prompt);
+    void setPersonality(const QString& name);  // For reference; the prompt carries the behavior
+    void setContextTokenBudget(int tokens);
+
+    // Chat operations
+    void sendMessage(const QString& message);  // Interrupts the reply in progress, if any
+    void cancelRequest();                      // Abandon the reply in progress, if any
+    void clearHistory();
+
+    // Status
+    const QString& id() const { return m_id; }
+    QString systemPrompt() const { return m_systemPrompt; }
+    QString personality() const { return m_personality; }
+    bool isProcessing() const { return m_isProcessing; }
+    const ConversationHistory& history() const { return *m_history; }
+
+signals:
+    // Emitted per streamed chunk (streaming mode only), before responseReceived
+    void partialResponseReceived(const QString& delta);
+    void responseReceived(const QString& response);
+    void errorOccurred(const QString& error);
+    void processingStarted();
+    void processingFinished();
+
+    // Emitted when the reply in progress is abandoned (cancelRequest or a new
+    // message), before processingFinished; no further chunks follow
+    void requestCancelled();
+
+private:
+    ChatRequest buildRequest();
+
+    // Response cache key for the latest user message (empty if caching is off)
+    std::string responseCacheKey() const;
+    void onReply(const QString& response, const CancellationToken& token);
+
+    // Between turns: condense older messages into the history summary in
+    // the background once the unsummarized part exceeds the threshold
+    void maybeSummarize();
+
+private:
+    QString m_id;
+    ChatEngine* m_engine;
+    QString m_systemPrompt;
+    QString m_personality;
+    bool m_isProcessing;
+    bool m_isSummarizing;
+    quint64 m_historyGeneration;  // Bumped by clearHistory to discard stale summaries
+
+    // Tokens of the latest reply and summary requests
+    CancellationToken m_requestToken;
+    CancellationToken m_summaryToken;
+
+    std::string m_cacheKey;  // Stores the pending reply in the response cache
+
+    std::unique_ptr<ConversationHistory> m_history;
+    std::unique_ptr<ContextBuilder> m_contextBuilder;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_CHATSESSION_H
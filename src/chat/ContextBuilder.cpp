@@ -0,0 +1,147 @@
+#include "chat/ContextBuilder.h"
+#include "chat/ConversationHistory.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+namespace Chatbot {
+
+namespace {
+// Role label and separators around each message in the prompt
+constexpr int kMessageOverheadTokens = 4;
+
+const std::string kSummaryHeader = "Summary of earlier conversation:\n";
+const std::string kHistoryHeader = "Previous conversation:\n";
+const std::string kCurrentHeader = "\nCurrent question:\n";
+const std::string kUserLabel = "User: ";
+const std::string kAssistantLabel = "Assistant: ";
+
+int messageCost(const Message& message) {
+    return message.tokenEstimate + kMessageOverheadTokens;
+}
+}
+
+ContextBuilder::ContextBuilder()
+    : m_tokenBudget(2048)  // Ollama's default context window
+    , m_windowStart(0)
+{
+}
+
+void ContextBuilder::setTokenBudget(int tokens) {
+    m_tokenBudget = std::max(0, tokens);
+    spdlog::info("Context token budget set to {}", m_tokenBudget);
+}
+
+void ContextBuilder::reset() {
+    m_windowStart = 0;
+}
+
+int ContextBuilder::estimateTokens(const std::string& text) {
+    return static_cast<int>((text.size() + 3) / 4);
+}
+
+ContextWindow ContextBuilder::select(const ConversationHistory& history, const std::string& systemPrompt) {
+    ContextWindow window;
+    if (history.isEmpty()) {
+        return window;
+    }
+
+    auto last = history.end() - 1;  // Current message, always included
+
+    // Resume at the previous window start so the prefix stays the same;
+    // summarized messages are never sent again
+    quint64 start = std::max(m_windowStart, history.summarizedThrough() + 1);
+    auto first = history.begin();
+    while (first != last && first->sequence < start) {
+        ++first;
+    }
+
+    int tokens = estimateTokens(systemPrompt) + kMessageOverheadTokens;
+    if (history.hasSummary()) {
+        tokens += messageCost(history.summary());
+        window.includesSummary = true;
+    }
+    for (auto it = first; it != history.end(); ++it) {
+        tokens += messageCost(*it);
+    }
+
+    // Over budget: move the start forward until half the budget is free, so
+    // the new prefix holds for several turns
+    if (m_tokenBudget > 0 && tokens > m_tokenBudget) {
+        int target = m_tokenBudget / 2;
+        while (first != last && tokens > target) {
+            tokens -= messageCost(*first);
+            ++first;
+        }
+        spdlog::debug("Context window moved to message {}", first->sequence);
+    }
+    m_windowStart = first->sequence;
+
+    window.firstIndex = static_cast<size_t>(first - history.begin());
+    window.messagesIncluded = static_cast<size_t>(history.end() - first);
+    window.messagesDropped = window.firstIndex;
+    window.estimatedTokens = tokens;
+
+    spdlog::debug("Context: {} messages (~{} tokens), {} older messages left out",
+                  window.messagesIncluded, window.estimatedTokens, window.messagesDropped);
+    return window;
+}
+
+std::string ContextBuilder::buildPrompt(const ConversationHistory& history, const ContextWindow& window) const {
+    if (window.messagesIncluded == 0) {
+        return std::string();
+    }
+
+    auto first = history.begin() + static_cast<std::ptrdiff_t>(window.firstIndex);
+    auto last = history.end() - 1;
+    const Message& current = *last;
+
+    // Size the prompt up front, then fill it without reallocating
+    size_t size = current.content.size();
+    if (window.includesSummary) {
+        size += kSummaryHeader.size() + history.summary().content.size() + 2;
+    }
+    if (first != last) {
+        size += kHistoryHeader.size() + kCurrentHeader.size();
+        for (auto it = first; it != last; ++it) {
+            size += kAssistantLabel.size() + it->content.size() + 1;
+        }
+    }
+
+    std::string prompt;
+    prompt.reserve(size);
+    if (window.includesSummary) {
+        prompt += kSummaryHeader;
+        prompt += history.summary().content;
+        prompt += "\n\n";
+    }
+    if (first != last) {
+        prompt += kHistoryHeader;
+        for (auto it = first; it != last; ++it) {
+            prompt += it->role == "user" ? kUserLabel : kAssistantLabel;
+            prompt += it->content;
+            prompt += '\n';
+        }
+        prompt += kCurrentHeader;
+    }
+    prompt += current.content;
+    return prompt;
+}
+
+nlohmann::json ContextBuilder::buildMessages(const ConversationHistory& history, const ContextWindow& window,
+                                             const std::string& systemPrompt) const {
+    nlohmann::json messages = nlohmann::json::array();
+    if (!systemPrompt.empty()) {
+        messages.push_back({{"role", "system"}, {"content", systemPrompt}});
+    }
+    if (window.includesSummary) {
+        messages.push_back({{"role", "system"}, {"content", kSummaryHeader + history.summary().content}});
+    }
+
+    // Stored verbatim, so earlier turns serialize identically on every request
+    for (auto it = history.begin() + static_cast<std::ptrdiff_t>(window.firstIndex); it != history.end(); ++it) {
+        messages.push_back({{"role", it->role}, {"content", it->content}});
+    }
+    return messages;
+}
+
+} // namespace Chatbot
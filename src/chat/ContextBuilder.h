@@ -0,0 +1,68 @@
+#ifndef CHATBOT_CONTEXTBUILDER_H
+#define CHATBOT_CONTEXTBUILDER_H
+
+#include <QtGlobal>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace Chatbot {
+
+class ConversationHistory;
+
+// Messages selected from the history for the next request
+struct ContextWindow {
+    size_t firstIndex = 0;        // History index of the oldest included message
+    size_t messagesIncluded = 0;  // Including the current message
+    size_t messagesDropped = 0;   // Older messages left out
+    int estimatedTokens = 0;      // Messages plus system prompt
+    bool includesSummary = false; // History summary goes before the messages
+};
+
+/**
+ * ContextBuilder turns the conversation history into the context for the
+ * next request, keeping it within a token budget: the system prompt and
+ * the current message always go in, plus as many earlier messages as fit.
+ * Token counts are estimated (no tokenizer) and cached on each Message
+ * when it is added to the history.
+ *
+ * The window start is sticky so consecutive requests share a byte-identical
+ * prefix, which lets Ollama reuse its KV cache and only evaluate the new
+ * turn. When the budget is exceeded the start jumps forward far enough to
+ * free half the budget, instead of sliding by one message every turn.
+ *
+ * If the history has a summary, it replaces the messages it covers.
+ */
+class ContextBuilder {
+public:
+    ContextBuilder();
+    ~ContextBuilder() = default;
+
+    // Tokens available for system prompt plus messages (0 = unlimited)
+    void setTokenBudget(int tokens);
+    int tokenBudget() const { return m_tokenBudget; }
+
+    // Choose the messages for the next request; the last history message is
+    // the current one
+    ContextWindow select(const ConversationHistory& history, const std::string& systemPrompt);
+
+    // Start over at the oldest message (e.g. after the history was cleared)
+    void reset();
+
+    // Plain-text prompt for /api/generate (system prompt is sent separately)
+    std::string buildPrompt(const ConversationHistory& history, const ContextWindow& window) const;
+
+    // "messages" array for /api/chat, starting with the system prompt
+    nlohmann::json buildMessages(const ConversationHistory& history, const ContextWindow& window,
+                                 const std::string& systemPrompt) const;
+
+    // Rough token count of text (about four bytes of English per token)
+    static int estimateTokens(const std::string& text);
+
+private:
+    int m_tokenBudget;
+    quint64 m_windowStart;  // Sequence number of the oldest message to include
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_CONTEXTBUILDER_H
@@ -5,8 +5,12 @@
 namespace Chatbot {
 
 ConversationHistory::ConversationHistory()
-    : m_maxMessages(100)  // Keep last 100 messages by default
+    : m_head(0)
+    , m_maxMessages(100)  // Keep last 100 messages by default
+    , m_nextSequence(1)
+    , m_summarizedThrough(0)
 {
+    m_slots.reserve(m_maxMessages);
     spdlog::debug("ConversationHistory created (max messages: {})", m_maxMessages);
 }
 
@@ -15,41 +19,70 @@ ConversationHistory::~ConversationHistory() {
 }
 
 void ConversationHistory::addUserMessage(const QString& message) {
-    m_messages.emplace_back("user", message.toStdString());
-    spdlog::debug("User message added to history (total: {})", m_messages.size());
+    append(Message("user", message.toStdString()));
+    spdlog::debug("User message added to history (total: {})", m_slots.size());
+}
+
+void ConversationHistory::addBotMessage(const QString& message) {
+    append(Message("assistant", message.toStdString()));
+    spdlog::debug("Bot message added to history (total: {})", m_slots.size());
+}
+
+void ConversationHistory::append(Message&& message) {
+    message.sequence = m_nextSequence++;
 
-    // Trim history if needed
-    if (m_maxMessages > 0 && m_messages.size() > m_maxMessages) {
-        m_messages.erase(m_messages.begin());
-        spdlog::debug("History trimmed to {} messages", m_messages.size());
+    if (m_maxMessages == 0 || m_slots.size() < m_maxMessages) {
+        m_slots.push_back(std::move(message));
+        return;
     }
+
+    // Full: overwrite the oldest message, which makes the next one the oldest
+    m_slots[m_head] = std::move(message);
+    m_head = (m_head + 1) % m_slots.size();
 }
 
-void ConversationHistory::addBotMessage(const QString& message) {
-    m_messages.emplace_back("assistant", message.toStdString());
-    spdlog::debug("Bot message added to history (total: {})", m_messages.size());
+void ConversationHistory::setMaxMessages(size_t maxMessages) {
+    linearize();
+
+    if (maxMessages > 0 && m_slots.size() > maxMessages) {
+        size_t dropped = m_slots.size() - maxMessages;
+        m_slots.erase(m_slots.begin(), m_slots.begin() + static_cast<std::ptrdiff_t>(dropped));
+        spdlog::debug("History trimmed to {} messages", m_slots.size());
+    }
 
-    // Trim history if needed
-    if (m_maxMessages > 0 && m_messages.size() > m_maxMessages) {
-        m_messages.erase(m_messages.begin());
-        spdlog::debug("History trimmed to {} messages", m_messages.size());
+    m_maxMessages = maxMessages;
+    if (m_maxMessages > 0) {
+        m_slots.reserve(std::min<size_t>(m_maxMessages, 1024));  // Large limits grow as needed
     }
+    spdlog::info("Conversation history limit set to {} messages", maxMessages);
 }
 
-std::vector<Message> ConversationHistory::getRecentMessages(size_t count) const {
-    if (count >= m_messages.size()) {
-        return m_messages;
+void ConversationHistory::linearize() {
+    if (m_head == 0) {
+        return;
     }
+    std::rotate(m_slots.begin(), m_slots.begin() + static_cast<std::ptrdiff_t>(m_head), m_slots.end());
+    m_head = 0;
+}
+
+ConversationHistory::MessageView ConversationHistory::getRecentMessages(size_t count) const {
+    count = std::min(count, m_slots.size());
+    return MessageView(end() - static_cast<std::ptrdiff_t>(count), end());
+}
 
-    return std::vector<Message>(
-        m_messages.end() - count,
-        m_messages.end()
-    );
+void ConversationHistory::setSummary(const std::string& summary, quint64 throughSequence) {
+    m_summary.emplace("system", summary);
+    m_summarizedThrough = throughSequence;
+    spdlog::info("Conversation summarized through message {} (~{} tokens)",
+                 throughSequence, m_summary->tokenEstimate);
 }
 
 void ConversationHistory::clear() {
-    size_t oldSize = m_messages.size();
-    m_messages.clear();
+    size_t oldSize = m_slots.size();
+    m_slots.clear();
+    m_head = 0;
+    m_summary.reset();
+    m_summarizedThrough = 0;
     spdlog::info("Conversation history cleared ({} messages removed)", oldSize);
 }
 
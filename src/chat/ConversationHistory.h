@@ -1,27 +1,95 @@
 #ifndef CHATBOT_CONVERSATIONHISTORY_H
 #define CHATBOT_CONVERSATIONHISTORY_H
 
+#include "chat/ContextBuilder.h"
 #include <QString>
 #include <QDateTime>
+#include <cstddef>
+#include <iterator>
+#include <optional>
 #include <vector>
 #include <string>
 
 namespace Chatbot {
 
 struct Message {
-    std::string role;        // "user" or "assistant"
+    std::string role;        // "user", "assistant" or "system" (summary)
     std::string content;
     QDateTime timestamp;
+    int tokenEstimate;       // Estimated once, used for every context window
+    quint64 sequence;        // Position in the conversation, assigned by ConversationHistory
 
     Message(const std::string& r, const std::string& c)
-        : role(r), content(c), timestamp(QDateTime::currentDateTime()) {}
+        : role(r), content(c), timestamp(QDateTime::currentDateTime())
+        , tokenEstimate(ContextBuilder::estimateTokens(c)), sequence(0) {}
 };
 
 /**
  * ConversationHistory manages the chat message history
+ *
+ * Messages live in a ring buffer: once the maximum is reached, each new
+ * message overwrites the oldest one in place. Messages are read through
+ * iterators (oldest first) without copying.
+ *
+ * Older messages can be condensed into a summary, which stands in for
+ * every message up to summarizedThrough() when building prompts. The
+ * messages themselves stay in the history.
  */
 class ConversationHistory {
 public:
+    // Random-access iterator over messages, oldest first
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Message;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Message*;
+        using reference = const Message&;
+
+        const_iterator() : m_history(nullptr), m_index(0) {}
+        const_iterator(const ConversationHistory* history, size_t index)
+            : m_history(history), m_index(index) {}
+
+        reference operator*() const { return m_history->at(m_index); }
+        pointer operator->() const { return &m_history->at(m_index); }
+        reference operator[](difference_type n) const { return m_history->at(m_index + n); }
+
+        const_iterator& operator++() { ++m_index; return *this; }
+        const_iterator operator++(int) { const_iterator it = *this; ++m_index; return it; }
+        const_iterator& operator--() { --m_index; return *this; }
+        const_iterator operator--(int) { const_iterator it = *this; --m_index; return it; }
+        const_iterator& operator+=(difference_type n) { m_index += n; return *this; }
+        const_iterator& operator-=(difference_type n) { m_index -= n; return *this; }
+        const_iterator operator+(difference_type n) const { return const_iterator(m_history, m_index + n); }
+        const_iterator operator-(difference_type n) const { return const_iterator(m_history, m_index - n); }
+        difference_type operator-(const const_iterator& other) const {
+            return static_cast<difference_type>(m_index) - static_cast<difference_type>(other.m_index);
+        }
+
+        bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+        bool operator<(const const_iterator& other) const { return m_index < other.m_index; }
+
+    private:
+        const ConversationHistory* m_history;
+        size_t m_index;  // 0 = oldest message
+    };
+
+    // A range of messages (oldest first), valid until the history changes
+    class MessageView {
+    public:
+        MessageView(const_iterator first, const_iterator last) : m_begin(first), m_end(last) {}
+
+        const_iterator begin() const { return m_begin; }
+        const_iterator end() const { return m_end; }
+        size_t size() const { return static_cast<size_t>(m_end - m_begin); }
+        bool empty() const { return m_begin == m_end; }
+
+    private:
+        const_iterator m_begin;
+        const_iterator m_end;
+    };
+
     ConversationHistory();
     ~ConversationHistory();
 
@@ -29,20 +97,44 @@ public:
     void addUserMessage(const QString& message);
     void addBotMessage(const QString& message);
 
-    // Get messages
-    const std::vector<Message>& getMessages() const { return m_messages; }
-    std::vector<Message> getRecentMessages(size_t count) const;
+    // Maximum messages to keep (0 = unlimited); shrinking drops the oldest
+    void setMaxMessages(size_t maxMessages);
+    size_t maxMessages() const { return m_maxMessages; }
+
+    // Get messages (index 0 = oldest)
+    const Message& at(size_t index) const { return m_slots[(m_head + index) % m_slots.size()]; }
+    const Message& back() const { return at(m_slots.size() - 1); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_slots.size()); }
+    MessageView getRecentMessages(size_t count) const;
+
+    // Summary of all messages up to and including the given sequence number
+    void setSummary(const std::string& summary, quint64 throughSequence);
+    bool hasSummary() const { return m_summary.has_value(); }
+    const Message& summary() const { return *m_summary; }
+    quint64 summarizedThrough() const { return m_summarizedThrough; }
 
     // Clear history
     void clear();
 
     // Get statistics
-    size_t messageCount() const { return m_messages.size(); }
-    bool isEmpty() const { return m_messages.empty(); }
+    size_t messageCount() const { return m_slots.size(); }
+    bool isEmpty() const { return m_slots.empty(); }
 
 private:
-    std::vector<Message> m_messages;
+    void append(Message&& message);
+    void linearize();
+
+private:
+    // Slot storage; m_head is the oldest message. Until the buffer is full,
+    // m_head is 0 and messages are appended in order.
+    std::vector<Message> m_slots;
+    size_t m_head;
     size_t m_maxMessages;  // Maximum messages to keep (0 = unlimited)
+    quint64 m_nextSequence;
+
+    std::optional<Message> m_summary;
+    quint64 m_summarizedThrough;  // 0 = nothing summarized
 };
 
 } // namespace Chatbot
@@ -0,0 +1,174 @@
+#include "chat/RequestScheduler.h"
+#include <spdlog/spdlog.h>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+
+namespace Chatbot {
+
+RequestScheduler::RequestScheduler(QObject *parent)
+    : QObject(parent)
+    , m_maxInFlight(2)          // Ollama's default parallelism on small machines
+    , m_maxQueuedPerSession(4)
+    , m_inFlight(0)
+    , m_started(0)
+    , m_lastWaitMs(0)
+    , m_maxWaitMs(0)
+    , m_totalWaitMs(0)
+{
+}
+
+void RequestScheduler::setMaxInFlight(int count) {
+    m_maxInFlight = std::max(1, count);
+    spdlog::info("Up to {} LLM requests in flight", m_maxInFlight);
+    dispatch();
+}
+
+void RequestScheduler::setMaxQueuedPerSession(int count) {
+    m_maxQueuedPerSession = std::max(0, count);
+    spdlog::info("Up to {} queued LLM requests per session", m_maxQueuedPerSession);
+}
+
+int RequestScheduler::waitingCount(const std::deque<Pending>& queue) const {
+    // Cancelled requests are dropped when their turn comes; they don't count
+    return static_cast<int>(std::count_if(queue.begin(), queue.end(), [](const Pending& pending) {
+        return !pending.token.isCancelled();
+    }));
+}
+
+bool RequestScheduler::canAccept(const QString& sessionId, RequestPriority priority) const {
+    if (m_maxQueuedPerSession == 0) {
+        return true;
+    }
+
+    auto it = m_queues.constFind(sessionId);
+    if (it == m_queues.constEnd()) {
+        return true;
+    }
+    const std::deque<Pending>& queue =
+        priority == RequestPriority::Interactive ? it->interactive : it->background;
+    return waitingCount(queue) < m_maxQueuedPerSession;
+}
+
+bool RequestScheduler::submit(const QString& sessionId, RequestPriority priority, CancellationToken token,
+                              Job job, Completion done) {
+    if (!canAccept(sessionId, priority)) {
+        spdlog::warn("Request queue full for session {}", sessionId.toStdString());
+        return false;
+    }
+
+    Pending pending;
+    pending.token = std::move(token);
+    pending.job = std::move(job);
+    pending.done = std::move(done);
+    pending.waited.start();
+
+    SessionQueue& queue = m_queues[sessionId];
+    if (queue.interactive.empty() && queue.background.empty()) {
+        m_roundRobin.push_back(sessionId);
+    }
+    if (priority == RequestPriority::Interactive) {
+        queue.interactive.push_back(std::move(pending));
+    } else {
+        queue.background.push_back(std::move(pending));
+    }
+
+    publishStats();
+    dispatch();
+    return true;
+}
+
+void RequestScheduler::dispatch() {
+    Pending next;
+    while (m_inFlight < m_maxInFlight && takeNext(next)) {
+        if (next.token.isCancelled()) {
+            next.done(QString());
+            continue;
+        }
+        start(std::move(next));
+    }
+}
+
+bool RequestScheduler::takeNext(Pending& next) {
+    // Replies before background work; within a priority, one request per
+    // session in turn
+    for (RequestPriority priority : {RequestPriority::Interactive, RequestPriority::Background}) {
+        for (size_t i = 0; i < m_roundRobin.size(); ++i) {
+            QString sessionId = m_roundRobin.front();
+            m_roundRobin.pop_front();
+
+            SessionQueue& queue = m_queues[sessionId];
+            std::deque<Pending>& pending =
+                priority == RequestPriority::Interactive ? queue.interactive : queue.background;
+            if (pending.empty()) {
+                m_roundRobin.push_back(sessionId);
+                continue;
+            }
+
+            next = std::move(pending.front());
+            pending.pop_front();
+
+            if (queue.interactive.empty() && queue.background.empty()) {
+                m_queues.remove(sessionId);
+            } else {
+                m_roundRobin.push_back(sessionId);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void RequestScheduler::start(Pending pending) {
+    qint64 waitMs = pending.waited.elapsed();
+    ++m_started;
+    m_lastWaitMs = waitMs;
+    m_maxWaitMs = std::max(m_maxWaitMs, waitMs);
+    m_totalWaitMs += waitMs;
+    ++m_inFlight;
+
+    spdlog::debug("LLM request started after {} ms in queue ({} in flight)", waitMs, m_inFlight);
+
+    QFutureWatcher<QString>* watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, done = std::move(pending.done)]() {
+        QString result = watcher->result();
+        watcher->deleteLater();
+
+        // Start the next request before handling this result
+        --m_inFlight;
+        dispatch();
+        publishStats();
+
+        done(result);
+    });
+    watcher->setFuture(QtConcurrent::run(&m_threadPool, std::move(pending.job)));
+
+    publishStats();
+}
+
+void RequestScheduler::waitForRunningJobs() {
+    m_threadPool.waitForDone();
+}
+
+SchedulerStats RequestScheduler::stats() const {
+    SchedulerStats stats;
+    stats.inFlight = m_inFlight;
+    for (const SessionQueue& queue : m_queues) {
+        int waiting = waitingCount(queue.interactive) + waitingCount(queue.background);
+        stats.queued += waiting;
+        if (waiting > 0) {
+            ++stats.sessionsWaiting;
+        }
+    }
+    stats.lastWaitMs = m_lastWaitMs;
+    stats.maxWaitMs = m_maxWaitMs;
+    stats.averageWaitMs = m_started > 0 ? static_cast<double>(m_totalWaitMs) / m_started : 0.0;
+    stats.started = m_started;
+    return stats;
+}
+
+void RequestScheduler::publishStats() {
+    emit statsChanged(stats());
+}
+
+} // namespace Chatbot
@@ -0,0 +1,112 @@
+#ifndef CHATBOT_REQUESTSCHEDULER_H
+#define CHATBOT_REQUESTSCHEDULER_H
+
+#include "core/CancellationToken.h"
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <deque>
+#include <functional>
+
+namespace Chatbot {
+
+// How urgently a request should run
+enum class RequestPriority {
+    Interactive,  // Someone is waiting for the reply
+    Background    // Housekeeping (e.g. summaries); only runs when no replies wait
+};
+
+// Snapshot of the scheduler's queues
+struct SchedulerStats {
+    int inFlight = 0;
+    int queued = 0;              // Waiting, uncancelled requests, all sessions and priorities
+    int sessionsWaiting = 0;     // Sessions with at least one waiting request
+    qint64 lastWaitMs = 0;       // Queue wait of the most recently started request
+    qint64 maxWaitMs = 0;
+    double averageWaitMs = 0.0;
+    quint64 started = 0;
+};
+
+/**
+ * RequestScheduler limits how many LLM requests run at once across all
+ * chat sessions. Requests beyond the limit wait in per-session queues that
+ * are served round-robin, so one busy session cannot starve the others,
+ * and each session may only have a few requests waiting (backpressure).
+ *
+ * Jobs run on the scheduler's own thread pool; completions are delivered on
+ * the scheduler's thread. A job whose token was cancelled while it waited is
+ * not run, but its completion is still called (with an empty result).
+ */
+class RequestScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    using Job = std::function<QString()>;
+    using Completion = std::function<void(const QString& result)>;
+
+    explicit RequestScheduler(QObject *parent = nullptr);
+    ~RequestScheduler() override = default;
+
+    // Delete copy constructor and assignment operator
+    RequestScheduler(const RequestScheduler&) = delete;
+    RequestScheduler& operator=(const RequestScheduler&) = delete;
+
+    void setMaxInFlight(int count);
+    void setMaxQueuedPerSession(int count);
+
+    // Whether submit() would accept another request for the session
+    bool canAccept(const QString& sessionId, RequestPriority priority = RequestPriority::Interactive) const;
+
+    // Queue a job; returns false (without calling done) if the session's queue is full
+    bool submit(const QString& sessionId, RequestPriority priority, CancellationToken token,
+                Job job, Completion done);
+
+    SchedulerStats stats() const;
+
+    // Block until every started job has returned (their completions run
+    // later, if at all); lets owners destroy what the jobs use
+    void waitForRunningJobs();
+
+signals:
+    // Emitted whenever a request is queued, started or finished
+    void statsChanged(const SchedulerStats& stats);
+
+private:
+    struct Pending {
+        CancellationToken token;
+        Job job;
+        Completion done;
+        QElapsedTimer waited;
+    };
+
+    struct SessionQueue {
+        std::deque<Pending> interactive;
+        std::deque<Pending> background;
+    };
+
+    void dispatch();
+    bool takeNext(Pending& next);
+    void start(Pending pending);
+    int waitingCount(const std::deque<Pending>& queue) const;
+    void publishStats();
+
+private:
+    QThreadPool m_threadPool;  // Running jobs, so they can be waited for
+    QHash<QString, SessionQueue> m_queues;
+    std::deque<QString> m_roundRobin;  // Sessions with waiting requests, next to serve first
+    int m_maxInFlight;
+    int m_maxQueuedPerSession;
+    int m_inFlight;
+
+    // Wait time statistics
+    quint64 m_started;
+    qint64 m_lastWaitMs;
+    qint64 m_maxWaitMs;
+    qint64 m_totalWaitMs;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_REQUESTSCHEDULER_H
@@ -0,0 +1,234 @@
+#include "chat/ResponseCache.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSaveFile>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <cctype>
+#include <iterator>
+
+using json = nlohmann::json;
+
+namespace Chatbot {
+
+ResponseCache::ResponseCache(size_t maxEntries, std::chrono::seconds timeToLive)
+    : m_maxEntries(maxEntries)
+    , m_maxBytes(4 * 1024 * 1024)
+    , m_bytes(0)
+    , m_timeToLive(timeToLive)
+{
+}
+
+void ResponseCache::setMaxEntries(size_t maxEntries) {
+    m_maxEntries = maxEntries;
+    evictOverflow();
+    spdlog::info("Response cache limited to {} entries", maxEntries);
+}
+
+void ResponseCache::setMaxBytes(size_t maxBytes) {
+    m_maxBytes = maxBytes;
+    evictOverflow();
+    spdlog::info("Response cache limited to {} bytes", maxBytes);
+}
+
+void ResponseCache::setTimeToLive(std::chrono::seconds timeToLive) {
+    m_timeToLive = timeToLive;
+}
+
+void ResponseCache::setPersistPath(const QString& path) {
+    m_persistPath = path;
+    if (!m_persistPath.isEmpty()) {
+        load();
+    }
+}
+
+std::string ResponseCache::makeKey(const std::string& model, const std::string& personality,
+                                   const std::string& systemPrompt, const std::vector<std::string>& context,
+                                   const std::string& message) {
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    auto addField = [&hash](const std::string& field) {
+        hash.addData(QByteArrayView(field.data(), static_cast<qsizetype>(field.size())));
+        hash.addData(QByteArrayView("\0", 1));  // Keeps "ab"+"c" apart from "a"+"bc"
+    };
+
+    addField(model);
+    addField(personality);
+    addField(systemPrompt);
+    for (const std::string& text : context) {
+        addField(normalize(text));
+    }
+    addField(normalize(message));
+
+    return hash.result().toHex().toStdString();
+}
+
+std::string ResponseCache::normalize(const std::string& text) {
+    std::string normalized;
+    normalized.reserve(text.size());
+
+    bool pendingSpace = false;
+    for (unsigned char c : text) {
+        if (std::isspace(c)) {
+            pendingSpace = !normalized.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            normalized += ' ';
+            pendingSpace = false;
+        }
+        normalized += static_cast<char>(std::tolower(c));
+    }
+
+    // "Hello!" and "hello" are the same question
+    while (!normalized.empty() && std::ispunct(static_cast<unsigned char>(normalized.back()))) {
+        normalized.pop_back();
+    }
+    return normalized;
+}
+
+std::optional<std::string> ResponseCache::lookup(const std::string& key) {
+    if (!isEnabled()) {
+        return std::nullopt;
+    }
+
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        ++m_stats.misses;
+        return std::nullopt;
+    }
+
+    if (Clock::now() - it->second->created > m_timeToLive) {
+        erase(it->second);
+        ++m_stats.expired;
+        ++m_stats.misses;
+        return std::nullopt;
+    }
+
+    // Move to the front: most recently used
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    ++m_stats.hits;
+    spdlog::debug("Response cache hit ({:.0f}% of {} lookups)",
+                  m_stats.hitRate() * 100.0, m_stats.hits + m_stats.misses);
+    return m_entries.front().reply;
+}
+
+void ResponseCache::insert(const std::string& key, const std::string& reply) {
+    if (!isEnabled() || reply.empty()) {
+        return;
+    }
+
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        erase(it->second);
+    }
+
+    Entry entry{key, reply, Clock::now()};
+    if (m_maxBytes > 0 && entryBytes(entry) > m_maxBytes) {
+        spdlog::debug("Reply of {} bytes exceeds the response cache budget", reply.size());
+        return;
+    }
+
+    m_bytes += entryBytes(entry);
+    m_entries.push_front(std::move(entry));
+    m_index[key] = m_entries.begin();
+    evictOverflow();
+
+    if (!m_persistPath.isEmpty()) {
+        save();
+    }
+}
+
+void ResponseCache::clear() {
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+    if (!m_persistPath.isEmpty()) {
+        save();
+    }
+    spdlog::info("Response cache cleared");
+}
+
+ResponseCacheStats ResponseCache::stats() const {
+    ResponseCacheStats stats = m_stats;
+    stats.entries = m_entries.size();
+    stats.bytes = m_bytes;
+    return stats;
+}
+
+void ResponseCache::erase(std::list<Entry>::iterator entry) {
+    m_bytes -= entryBytes(*entry);
+    m_index.erase(entry->key);
+    m_entries.erase(entry);
+}
+
+void ResponseCache::evictOverflow() {
+    while (!m_entries.empty()
+           && (m_entries.size() > m_maxEntries || (m_maxBytes > 0 && m_bytes > m_maxBytes))) {
+        erase(std::prev(m_entries.end()));
+        ++m_stats.evicted;
+    }
+}
+
+void ResponseCache::load() {
+    QFile file(m_persistPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        spdlog::debug("No response cache at {}", m_persistPath.toStdString());
+        return;
+    }
+
+    QByteArray data = file.readAll();
+    json stored = json::parse(data.constData(), data.constData() + data.size(), nullptr, false);
+    if (stored.is_discarded() || !stored.is_array()) {
+        spdlog::warn("Ignoring malformed response cache {}", m_persistPath.toStdString());
+        return;
+    }
+
+    // Stored most recently used first; append in that order
+    Clock::time_point now = Clock::now();
+    for (const json& item : stored) {
+        // Entries with missing or mistyped fields are skipped (value() would throw)
+        if (!item.is_object() || !item.contains("key") || !item["key"].is_string()
+            || !item.contains("reply") || !item["reply"].is_string()
+            || (item.contains("created") && !item["created"].is_number_integer())) {
+            continue;
+        }
+        std::string key = item["key"].get<std::string>();
+        if (m_index.count(key) > 0) {
+            continue;
+        }
+
+        Clock::time_point created{std::chrono::seconds(item.value("created", int64_t(0)))};
+        if (now - created > m_timeToLive) {
+            continue;
+        }
+
+        m_entries.push_back(Entry{key, item["reply"].get<std::string>(), created});
+        m_index[key] = std::prev(m_entries.end());
+        m_bytes += entryBytes(m_entries.back());
+    }
+    evictOverflow();
+
+    spdlog::info("Loaded {} cached responses from {}", m_entries.size(), m_persistPath.toStdString());
+}
+
+void ResponseCache::save() const {
+    json stored = json::array();
+    for (const Entry& entry : m_entries) {
+        auto created = std::chrono::duration_cast<std::chrono::seconds>(entry.created.time_since_epoch());
+        stored.push_back({{"key", entry.key}, {"reply", entry.reply}, {"created", created.count()}});
+    }
+
+    // Written to a temporary file and renamed, so a crash never leaves half a cache
+    QSaveFile file(m_persistPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        spdlog::warn("Cannot write response cache {}", m_persistPath.toStdString());
+        return;
+    }
+    std::string data = stored.dump();
+    file.write(data.data(), static_cast<qint64>(data.size()));
+    if (!file.commit()) {
+        spdlog::warn("Failed to save response cache {}", m_persistPath.toStdString());
+    }
+}
+
+} // namespace Chatbot
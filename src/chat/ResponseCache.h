@@ -0,0 +1,104 @@
+#ifndef CHATBOT_RESPONSECACHE_H
+#define CHATBOT_RESPONSECACHE_H
+
+#include <QString>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Chatbot {
+
+// Counters since the cache was created
+struct ResponseCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t expired = 0;   // Lookups that found an entry past its TTL
+    uint64_t evicted = 0;   // Entries dropped to stay within the limits
+    size_t entries = 0;
+    size_t bytes = 0;       // Keys and replies of the current entries
+
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+};
+
+/**
+ * ResponseCache remembers LLM replies to prompts that come up again and
+ * again (greetings, FAQ questions), so they can be answered without a
+ * generation. Keys are built from the model, the system prompt, the last
+ * few messages and the user message, normalized so that differences in
+ * case, spacing and trailing punctuation still hit.
+ *
+ * Least recently used entries are evicted beyond the entry limit or the
+ * byte budget (keys plus replies, so a few very long replies cannot grow
+ * the cache and its file without bound); entries older than the TTL are
+ * not returned. With a persist path set, entries are loaded from and
+ * written back to a JSON file so they survive restarts.
+ *
+ * Not thread-safe; used from the chat sessions' thread only.
+ */
+class ResponseCache {
+public:
+    explicit ResponseCache(size_t maxEntries = 128, std::chrono::seconds timeToLive = std::chrono::hours(1));
+    ~ResponseCache() = default;
+
+    // Delete copy constructor and assignment operator
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    // 0 entries disables the cache
+    void setMaxEntries(size_t maxEntries);
+    void setMaxBytes(size_t maxBytes);  // 0 = no byte limit
+    void setTimeToLive(std::chrono::seconds timeToLive);
+
+    // Load entries from path and save there on every insert (empty = memory only)
+    void setPersistPath(const QString& path);
+
+    static std::string makeKey(const std::string& model, const std::string& personality,
+                               const std::string& systemPrompt, const std::vector<std::string>& context,
+                               const std::string& message);
+
+    // Lowercase, single spaces, no surrounding whitespace or trailing punctuation
+    static std::string normalize(const std::string& text);
+
+    std::optional<std::string> lookup(const std::string& key);
+    void insert(const std::string& key, const std::string& reply);
+    void clear();
+
+    bool isEnabled() const { return m_maxEntries > 0; }
+    ResponseCacheStats stats() const;
+
+private:
+    using Clock = std::chrono::system_clock;  // Wall clock, comparable across restarts
+
+    struct Entry {
+        std::string key;
+        std::string reply;
+        Clock::time_point created;
+    };
+
+    static size_t entryBytes(const Entry& entry) { return entry.key.size() + entry.reply.size(); }
+    void erase(std::list<Entry>::iterator entry);
+    void evictOverflow();
+    void load();
+    void save() const;
+
+private:
+    std::list<Entry> m_entries;  // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+    size_t m_maxEntries;
+    size_t m_maxBytes;
+    size_t m_bytes;  // entryBytes() of all entries
+    std::chrono::seconds m_timeToLive;
+    QString m_persistPath;
+    ResponseCacheStats m_stats;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_RESPONSECACHE_H
@@ -0,0 +1,64 @@
+#include "chat/SessionPool.h"
+#include <spdlog/spdlog.h>
+
+namespace Chatbot {
+
+SessionPool::Lease::~Lease() {
+    if (m_pool && m_session) {
+        m_pool->release(std::move(m_session));
+    }
+}
+
+SessionPool::SessionPool(size_t maxIdle)
+    : m_maxIdle(maxIdle)
+    , m_connectTimeout(5000)
+    , m_readTimeout(120)  // Loading a model can keep the first byte waiting a while
+{
+}
+
+void SessionPool::setTimeouts(std::chrono::milliseconds connectTimeout, std::chrono::seconds readTimeout) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_connectTimeout = connectTimeout;
+    m_readTimeout = readTimeout;
+    spdlog::info("HTTP timeouts: connect {} ms, read {} s", connectTimeout.count(), readTimeout.count());
+}
+
+SessionPool::Lease SessionPool::acquire() {
+    std::unique_ptr<cpr::Session> session;
+    std::chrono::milliseconds connectTimeout;
+    std::chrono::seconds readTimeout;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idle.empty()) {
+            session = std::move(m_idle.back());
+            m_idle.pop_back();
+        }
+        connectTimeout = m_connectTimeout;
+        readTimeout = m_readTimeout;
+    }
+
+    if (!session) {
+        session = std::make_unique<cpr::Session>();
+        spdlog::debug("Created HTTP session");
+    }
+
+    session->SetConnectTimeout(cpr::ConnectTimeout{connectTimeout});
+    // Abort when less than one byte per second arrives for the whole timeout
+    session->SetLowSpeed(cpr::LowSpeed{1, static_cast<std::int32_t>(readTimeout.count())});
+
+    return Lease(this, std::move(session));
+}
+
+void SessionPool::release(std::unique_ptr<cpr::Session> session) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_idle.size() < m_maxIdle) {
+        m_idle.push_back(std::move(session));
+    }
+}
+
+void SessionPool::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idle.clear();
+}
+
+} // namespace Chatbot
@@ -0,0 +1,75 @@
+#ifndef CHATBOT_SESSIONPOOL_H
+#define CHATBOT_SESSIONPOOL_H
+
+#include <cpr/cpr.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Chatbot {
+
+/**
+ * SessionPool keeps idle cpr::Sessions for reuse. Each session owns a curl
+ * handle whose connection cache survives between requests, so consecutive
+ * requests to Ollama reuse the same keep-alive TCP connection instead of
+ * reconnecting every turn.
+ *
+ * Thread-safe: sessions are leased from worker threads and returned when
+ * the Lease goes out of scope.
+ */
+class SessionPool {
+public:
+    // Exclusive use of one session; returns it to the pool on destruction
+    class Lease {
+    public:
+        Lease(SessionPool* pool, std::unique_ptr<cpr::Session> session)
+            : m_pool(pool), m_session(std::move(session)) {}
+        Lease(Lease&& other) noexcept = default;
+        ~Lease();
+
+        cpr::Session& operator*() const { return *m_session; }
+        cpr::Session* operator->() const { return m_session.get(); }
+
+        // Delete copy constructor and assignment operator
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+    private:
+        SessionPool* m_pool;
+        std::unique_ptr<cpr::Session> m_session;
+    };
+
+    explicit SessionPool(size_t maxIdle = 4);
+    ~SessionPool() = default;
+
+    // Applied to every session handed out from now on. The read timeout
+    // aborts a transfer that receives nothing for that long (a stalled
+    // stream), not one that is merely slow overall.
+    void setTimeouts(std::chrono::milliseconds connectTimeout, std::chrono::seconds readTimeout);
+
+    Lease acquire();
+
+    // Close idle connections (e.g. after the server URL changed)
+    void clear();
+
+    // Delete copy constructor and assignment operator
+    SessionPool(const SessionPool&) = delete;
+    SessionPool& operator=(const SessionPool&) = delete;
+
+private:
+    void release(std::unique_ptr<cpr::Session> session);
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<cpr::Session>> m_idle;
+    size_t m_maxIdle;
+    std::chrono::milliseconds m_connectTimeout;
+    std::chrono::seconds m_readTimeout;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_SESSIONPOOL_H
@@ -2,20 +2,39 @@
 #include "ui/MainWindow.h"
 #include "ui/AvatarViewport.h"
 #include "chat/ChatEngine.h"
+#include "chat/ChatSession.h"
 #include "tts/TTSEngine.h"
+#include "tts/SentenceSplitter.h"
 #include "avatar/AvatarEngine.h"
 #include "emotion/EmotionDetector.h"
+#include "emotion/IncrementalEmotionScorer.h"
 #include "personality/PersonalityManager.h"
+#include "server/HeadlessServer.h"
+#include <QApplication>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 #include <spdlog/spdlog.h>
 
 namespace Chatbot {
 
+namespace {
+
+// Shown and spoken when the user switches personality
+QString personalitySwitchMessage(const QString& personalityName) {
+    return QString("Switched to %1 personality").arg(personalityName);
+}
+
+} // namespace
+
 Application* Application::s_instance = nullptr;
 
 Application::Application(int argc, char *argv[])
     : QObject(nullptr)
     , m_argc(argc)
     , m_argv(argv)
+    , m_headless(false)
+    , m_socketName("chatbot")
 {
     if (s_instance) {
         spdlog::error("Application instance already exists!");
@@ -27,12 +46,24 @@ Application::Application(int argc, char *argv[])
     spdlog::set_level(spdlog::level::debug);
     spdlog::info("Initializing Chatbot Application v1.0.0");
 
-    // Create QApplication
-    m_qApp = std::make_unique<QApplication>(m_argc, m_argv);
+    parseArguments();
+
+    // Headless mode needs no GUI, so it also runs without a display
+    if (m_headless) {
+        m_qApp = std::make_unique<QCoreApplication>(m_argc, m_argv);
+    } else {
+        m_qApp = std::make_unique<QApplication>(m_argc, m_argv);
+    }
     m_qApp->setApplicationName("Chatbot");
     m_qApp->setApplicationVersion("1.0.0");
     m_qApp->setOrganizationName("Chatbot");
 
+    if (m_headless) {
+        m_server = std::make_unique<HeadlessServer>();
+        spdlog::info("HeadlessServer initialized");
+        return;
+    }
+
     initializeComponents();
     setupConnections();
 }
@@ -46,6 +77,18 @@ Application* Application::instance() {
     return s_instance;
 }
 
+void Application::parseArguments() {
+    // Read before Q(Core)Application exists, which decides on the mode
+    for (int i = 1; i < m_argc; ++i) {
+        QString arg = QString::fromLocal8Bit(m_argv[i]);
+        if (arg == "--headless") {
+            m_headless = true;
+        } else if (arg == "--socket" && i + 1 < m_argc) {
+            m_socketName = QString::fromLocal8Bit(m_argv[++i]);
+        }
+    }
+}
+
 void Application::initializeComponents() {
     spdlog::info("Initializing components...");
 
@@ -55,10 +98,12 @@ void Application::initializeComponents() {
 
     // Create TTSEngine
     m_ttsEngine = std::make_unique<TTSEngine>();
+    m_sentenceSplitter = std::make_unique<SentenceSplitter>();
     spdlog::info("TTSEngine initialized");
 
     // Create EmotionDetector
-    m_emotionDetector = std::make_unique<EmotionDetector>();
+    m_emotionDetector = std::make_shared<const EmotionDetector>();
+    m_emotionScorer = std::make_unique<IncrementalEmotionScorer>(m_emotionDetector);
     spdlog::info("EmotionDetector initialized");
 
     // Create PersonalityManager
@@ -91,7 +136,13 @@ void Application::setupConnections() {
     QObject::connect(m_mainWindow.get(), &MainWindow::userMessageSubmitted,
                     m_chatEngine.get(), &ChatEngine::sendMessage);
 
+    QObject::connect(m_mainWindow.get(), &MainWindow::stopRequested,
+                    m_chatEngine.get(), &ChatEngine::cancelRequest);
+
     // Connect ChatEngine to MainWindow
+    QObject::connect(m_chatEngine.get(), &ChatEngine::partialResponseReceived,
+                    m_mainWindow.get(), &MainWindow::appendBotMessageDelta);
+
     QObject::connect(m_chatEngine.get(), &ChatEngine::responseReceived,
                     m_mainWindow.get(), &MainWindow::addBotMessage);
 
@@ -103,9 +154,47 @@ void Application::setupConnections() {
                         m_mainWindow->addSystemMessage("Thinking...");
                     });
 
-    // Connect ChatEngine to TTSEngine (speak bot responses)
+    QObject::connect(m_chatEngine.get(), &ChatEngine::requestCancelled,
+                    m_mainWindow.get(), [this]() {
+                        m_mainWindow->cancelBotMessage();
+                        m_mainWindow->addSystemMessage("Stopped");
+                    });
+
+    // Connect ChatEngine to TTSEngine (speak bot responses sentence by sentence,
+    // so speech starts as soon as the first sentence has been generated)
+    QObject::connect(m_chatEngine.get(), &ChatEngine::processingStarted,
+                    m_ttsEngine.get(), [this]() {
+                        m_sentenceSplitter->reset();
+                        m_ttsEngine->stop();
+                    });
+
+    // Cut off speech as soon as the reply is abandoned, not when the next one starts
+    QObject::connect(m_chatEngine.get(), &ChatEngine::requestCancelled,
+                    m_ttsEngine.get(), [this]() {
+                        m_sentenceSplitter->reset();
+                        m_ttsEngine->stop();
+                    });
+
+    QObject::connect(m_chatEngine.get(), &ChatEngine::partialResponseReceived,
+                    m_ttsEngine.get(), [this](const QString& delta) {
+                        for (const QString& sentence : m_sentenceSplitter->feed(delta)) {
+                            m_ttsEngine->enqueue(sentence);
+                        }
+                    });
+
     QObject::connect(m_chatEngine.get(), &ChatEngine::responseReceived,
-                    m_ttsEngine.get(), &TTSEngine::synthesize);
+                    m_ttsEngine.get(), [this](const QString& response) {
+                        // Without streaming the whole reply arrives here at once
+                        if (!m_sentenceSplitter->hasReceivedText()) {
+                            for (const QString& sentence : m_sentenceSplitter->feed(response)) {
+                                m_ttsEngine->enqueue(sentence);
+                            }
+                        }
+                        QString remainder = m_sentenceSplitter->flush();
+                        if (!remainder.isEmpty()) {
+                            m_ttsEngine->enqueue(remainder);
+                        }
+                    });
 
     // Connect TTSEngine to MainWindow (status messages)
     QObject::connect(m_ttsEngine.get(), &TTSEngine::synthesisStarted,
@@ -116,12 +205,18 @@ void Application::setupConnections() {
     QObject::connect(m_ttsEngine.get(), &TTSEngine::errorOccurred,
                     m_mainWindow.get(), &MainWindow::addSystemMessage);
 
-    // Connect TTSEngine to AvatarEngine (lip-sync)
+    // Connect TTSEngine to AvatarEngine (lip-sync), sampled once per rendered frame
+    QObject::connect(m_mainWindow->getAvatarViewport(), &AvatarViewport::animationTick,
+                    m_ttsEngine.get(), &TTSEngine::updateLipSync);
+
     auto avatarEngine = m_mainWindow->getAvatarViewport()->getAvatarEngine();
     if (avatarEngine) {
-        QObject::connect(m_ttsEngine.get(), &TTSEngine::currentPhoneme,
-                        avatarEngine, [avatarEngine](const Phoneme& phoneme, int index) {
-                            avatarEngine->applyPhoneme(phoneme.symbol);
+        // Timelines are resolved to visemes once, when synthesized; playback
+        // only reports mouth shape changes
+        m_ttsEngine->setVisemeMapper(avatarEngine->getVisemeMapper());
+        QObject::connect(m_ttsEngine.get(), &TTSEngine::visemeChanged,
+                        avatarEngine, [avatarEngine](const Viseme& viseme) {
+                            avatarEngine->applyViseme(viseme, 0.5f);  // Use blending
                         });
 
         QObject::connect(m_ttsEngine.get(), &TTSEngine::playbackFinished,
@@ -129,14 +224,45 @@ void Application::setupConnections() {
                             // Return to silence/rest position when done speaking
                             avatarEngine->applyPhoneme("");
                         });
+
+        // Interrupted speech never reaches playbackFinished
+        QObject::connect(m_chatEngine.get(), &ChatEngine::requestCancelled,
+                        avatarEngine, [this, avatarEngine]() {
+                            m_emotionScorer->reset();
+                            avatarEngine->applyPhoneme("");
+                        });
         spdlog::info("Lip-sync connections established");
 
-        // Connect ChatEngine to EmotionDetector to AvatarEngine (emotional expressions)
+        // Connect ChatEngine to EmotionDetector to AvatarEngine (emotional expressions),
+        // scored while the reply streams in so the expression follows along
+        QObject::connect(m_chatEngine.get(), &ChatEngine::processingStarted,
+                        m_emotionScorer.get(), &IncrementalEmotionScorer::reset);
+
+        QObject::connect(m_chatEngine.get(), &ChatEngine::partialResponseReceived,
+                        m_emotionScorer.get(), &IncrementalEmotionScorer::feed);
+
         QObject::connect(m_chatEngine.get(), &ChatEngine::responseReceived,
-                        this, [this, avatarEngine](const QString& response) {
-                            // Detect emotion from bot response text
-                            Emotion emotion = m_emotionDetector->detectEmotion(response);
-                            // Apply emotion to avatar
+                        m_emotionScorer.get(), [this, avatarEngine](const QString& response) {
+                            if (m_emotionScorer->hasReceivedText()) {
+                                m_emotionScorer->finish();
+                                return;
+                            }
+
+                            // Without streaming the whole reply arrives here at once;
+                            // analyze it on the thread pool, alongside synthesis
+                            auto watcher = new QFutureWatcher<EmotionResult>(this);
+                            QObject::connect(watcher, &QFutureWatcher<EmotionResult>::finished,
+                                            avatarEngine, [watcher, avatarEngine]() {
+                                                avatarEngine->applyEmotion(watcher->result().emotion);
+                                                watcher->deleteLater();
+                                            });
+                            watcher->setFuture(QtConcurrent::run([detector = m_emotionDetector, response]() {
+                                return detector->analyze(response);
+                            }));
+                        });
+
+        QObject::connect(m_emotionScorer.get(), &IncrementalEmotionScorer::emotionDetected,
+                        avatarEngine, [avatarEngine](Emotion emotion) {
                             avatarEngine->applyEmotion(emotion);
                         });
         spdlog::info("Emotion detection connections established");
@@ -149,17 +275,25 @@ void Application::setupConnections() {
                         if (m_personalityManager->setPersonality(personalityName)) {
                             Personality personality = m_personalityManager->getCurrentPersonality();
 
+                            // A reply still streaming was written for the old personality;
+                            // abandoning it also ends its message and speech, so the switch
+                            // message below is spoken on its own
+                            m_chatEngine->cancelRequest();
+
                             // Update ChatEngine system prompt
                             m_chatEngine->setSystemPrompt(personality.systemPrompt);
+                            m_chatEngine->defaultSession()->setPersonality(personalityName);
 
                             // Update avatar default emotion
                             if (avatarEngine) {
                                 avatarEngine->applyEmotion(personality.defaultEmotion);
                             }
 
-                            // Show system message
-                            QString message = QString("Switched to %1 personality").arg(personalityName);
+                            // Show and speak system message (usually already in the audio
+                            // cache, see startWarmup)
+                            QString message = personalitySwitchMessage(personalityName);
                             m_mainWindow->addSystemMessage(message);
+                            m_ttsEngine->synthesize(message);
 
                             spdlog::info("Personality switched to: {}", personalityName.toStdString());
                         }
@@ -169,12 +303,35 @@ void Application::setupConnections() {
     spdlog::info("Connections established");
 }
 
+void Application::startWarmup() {
+    // Load the model while the user reads the window
+    m_chatEngine->preloadModel();
+
+    // Switch messages are synthesized whenever nothing is being spoken
+    QStringList messages;
+    for (const QString& name : m_personalityManager->getAvailablePersonalities()) {
+        messages.append(personalitySwitchMessage(name));
+    }
+    m_ttsEngine->prewarm(messages);
+}
+
 int Application::run() {
     spdlog::info("Starting application...");
 
+    if (m_headless) {
+        if (!m_server->listen(m_socketName)) {
+            return 1;
+        }
+        spdlog::info("Application running headless");
+        return m_qApp->exec();
+    }
+
     // Show main window
     m_mainWindow->show();
 
+    // Warm-up waits until the event loop has put the window on screen
+    QTimer::singleShot(0, this, &Application::startWarmup);
+
     spdlog::info("Application running");
     return m_qApp->exec();
 }
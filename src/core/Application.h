@@ -1,8 +1,9 @@
 #ifndef CHATBOT_APPLICATION_H
 #define CHATBOT_APPLICATION_H
 
-#include <QApplication>
+#include <QCoreApplication>
 #include <QObject>
+#include <QString>
 #include <memory>
 
 namespace Chatbot {
@@ -11,8 +12,11 @@ namespace Chatbot {
 class MainWindow;
 class ChatEngine;
 class TTSEngine;
+class SentenceSplitter;
 class EmotionDetector;
+class IncrementalEmotionScorer;
 class PersonalityManager;
+class HeadlessServer;
 
 class Application : public QObject {
     Q_OBJECT
@@ -34,19 +38,28 @@ public:
 private:
     void initializeComponents();
     void setupConnections();
+    void parseArguments();
+
+    // Precompute what the first interactions need, after the window is shown
+    void startWarmup();
 
 private:
     static Application* s_instance;
 
-    std::unique_ptr<QApplication> m_qApp;
+    std::unique_ptr<QCoreApplication> m_qApp;  // QApplication unless headless
     std::unique_ptr<MainWindow> m_mainWindow;
     std::unique_ptr<ChatEngine> m_chatEngine;
     std::unique_ptr<TTSEngine> m_ttsEngine;
-    std::unique_ptr<EmotionDetector> m_emotionDetector;
+    std::unique_ptr<SentenceSplitter> m_sentenceSplitter;
+    std::shared_ptr<const EmotionDetector> m_emotionDetector;  // Immutable, shared with worker threads
+    std::unique_ptr<IncrementalEmotionScorer> m_emotionScorer;
     std::unique_ptr<PersonalityManager> m_personalityManager;
+    std::unique_ptr<HeadlessServer> m_server;
 
     int m_argc;
     char** m_argv;
+    bool m_headless;       // --headless: serve over a local socket, no UI
+    QString m_socketName;  // --socket <name>
 };
 
 } // namespace Chatbot
@@ -0,0 +1,28 @@
+#ifndef CHATBOT_CANCELLATIONTOKEN_H
+#define CHATBOT_CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <memory>
+
+namespace Chatbot {
+
+/**
+ * CancellationToken is a flag shared by all copies of a token: the owner
+ * keeps one copy to cancel() and hands the others to the work it may need
+ * to abort, which checks isCancelled() at convenient points. Safe to use
+ * from any thread.
+ */
+class CancellationToken {
+public:
+    CancellationToken() : m_cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { m_cancelled->store(true); }
+    bool isCancelled() const { return m_cancelled->load(); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_CANCELLATIONTOKEN_H
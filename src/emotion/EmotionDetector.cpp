@@ -4,6 +4,9 @@
 
 namespace Chatbot {
 
+static_assert(static_cast<int>(Emotion::Worried) + 1 == kEmotionCount,
+              "kEmotionCount must match the Emotion enum");
+
 QString emotionToString(Emotion emotion) {
     switch (emotion) {
         case Emotion::Neutral:     return "Neutral";
@@ -17,7 +20,6 @@ QString emotionToString(Emotion emotion) {
 }
 
 EmotionDetector::EmotionDetector()
-    : m_lastConfidence(0.0f)
 {
     initializeKeywords();
     spdlog::info("EmotionDetector initialized with keyword-based analysis");
@@ -28,14 +30,14 @@ void EmotionDetector::initializeKeywords() {
     m_emotionKeywords[Emotion::Happy] = {
         "happy", "great", "wonderful", "excellent", "fantastic", "amazing",
         "glad", "joy", "delighted", "pleased", "excited", "love",
-        "awesome", "perfect", "brilliant", "congratulations", "celebrate",
-        "fun", "enjoy", "smile", "laugh", "nice", "good"
+        "awesome", "perfect", "brilliant", "congratulations", "celebrat*",
+        "fun", "enjoy*", "smil*", "laugh*", "nice", "good"
     };
 
     // Sad keywords
     m_emotionKeywords[Emotion::Sad] = {
-        "sad", "sorry", "unfortunate", "regret", "disappointed", "miss",
-        "loss", "difficult", "hard", "tough", "struggle", "pain",
+        "sad", "sorry", "unfortunate", "regret", "disappoint*", "miss",
+        "loss", "difficult", "hard", "tough", "struggl*", "pain",
         "hurt", "cry", "unhappy", "depressed", "down", "blue",
         "terrible", "awful", "bad", "poor"
     };
@@ -43,7 +45,7 @@ void EmotionDetector::initializeKeywords() {
     // Surprised keywords
     m_emotionKeywords[Emotion::Surprised] = {
         "wow", "amazing", "incredible", "unbelievable", "shocking", "unexpected",
-        "surprise", "astonish", "remarkable", "extraordinary", "stunning",
+        "surpris*", "astonish*", "remarkable", "extraordinary", "stunning",
         "whoa", "really", "seriously", "no way", "can't believe"
     };
 
@@ -51,67 +53,61 @@ void EmotionDetector::initializeKeywords() {
     m_emotionKeywords[Emotion::Thoughtful] = {
         "think", "consider", "perhaps", "maybe", "possibly", "might",
         "could", "wonder", "question", "curious", "interesting", "hmm",
-        "let me", "analyze", "examine", "ponder", "reflect", "contemplate",
+        "let me", "analy*", "examine", "ponder", "reflect", "contemplate",
         "understand", "learn", "explore", "investigate"
     };
 
     // Worried keywords
     m_emotionKeywords[Emotion::Worried] = {
-        "worried", "concern", "afraid", "fear", "anxious", "nervous",
+        "worried", "concern*", "afraid", "fear", "anxious", "nervous",
         "stress", "trouble", "problem", "issue", "danger", "risk",
         "careful", "caution", "warning", "alert", "uncertain", "unsure",
         "doubt", "hesitant", "worry"
     };
-}
-
-Emotion EmotionDetector::detectEmotion(const QString& text) const {
-    QString lowerText = text.toLower();
 
-    // Count keyword matches for each emotion
-    QMap<Emotion, int> scores;
+    // One automaton for all lists, so a reply is scanned once; categories
+    // are Emotion values and index EmotionResult::scores
     for (auto it = m_emotionKeywords.constBegin(); it != m_emotionKeywords.constEnd(); ++it) {
-        scores[it.key()] = countKeywordMatches(lowerText, it.value());
+        for (const QString& keyword : it.value()) {
+            m_automaton.addKeyword(keyword, static_cast<int>(it.key()));
+        }
     }
+    m_automaton.build();
+}
+
+EmotionResult EmotionDetector::analyze(const QString& text) const {
+    EmotionResult result;
+
+    // Count whole-word keyword matches for all emotions in one pass
+    m_automaton.count(text, result.scores.data());
 
     // Find emotion with highest score
-    Emotion detectedEmotion = Emotion::Neutral;
     int maxScore = 0;
-
-    for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
-        if (it.value() > maxScore) {
-            maxScore = it.value();
-            detectedEmotion = it.key();
+    for (int i = 0; i < kEmotionCount; ++i) {
+        if (result.scores[i] > maxScore) {
+            maxScore = result.scores[i];
+            result.emotion = static_cast<Emotion>(i);
         }
     }
 
-    // Calculate confidence based on score
-    // Higher scores = higher confidence, cap at 1.0
-    m_lastConfidence = std::min(1.0f, maxScore * 0.3f);
+    result.confidence = confidenceForScore(maxScore);
 
     // If confidence is too low, default to neutral
-    if (m_lastConfidence < 0.2f) {
-        detectedEmotion = Emotion::Neutral;
-        m_lastConfidence = 1.0f; // High confidence in neutrality
+    if (result.confidence < 0.2f) {
+        result.emotion = Emotion::Neutral;
+        result.confidence = 1.0f; // High confidence in neutrality
     }
 
     spdlog::debug("Detected emotion: {} (confidence: {:.2f}, score: {})",
-                  emotionToString(detectedEmotion).toStdString(),
-                  m_lastConfidence, maxScore);
+                  emotionToString(result.emotion).toStdString(),
+                  result.confidence, maxScore);
 
-    return detectedEmotion;
+    return result;
 }
 
-int EmotionDetector::countKeywordMatches(const QString& text, const QStringList& keywords) const {
-    int count = 0;
-    for (const QString& keyword : keywords) {
-        // Count occurrences of this keyword (case-insensitive)
-        int index = 0;
-        while ((index = text.indexOf(keyword, index, Qt::CaseInsensitive)) != -1) {
-            count++;
-            index += keyword.length();
-        }
-    }
-    return count;
+float EmotionDetector::confidenceForScore(int score) {
+    // Higher scores = higher confidence, cap at 1.0
+    return std::min(1.0f, score * 0.3f);
 }
 
 } // namespace Chatbot
@@ -1,9 +1,11 @@
 #ifndef CHATBOT_EMOTIONDETECTOR_H
 #define CHATBOT_EMOTIONDETECTOR_H
 
+#include "emotion/KeywordAutomaton.h"
 #include <QString>
 #include <QMap>
 #include <QStringList>
+#include <array>
 
 namespace Chatbot {
 
@@ -17,29 +19,49 @@ enum class Emotion {
     Worried
 };
 
+constexpr int kEmotionCount = 6;
+
 // Converts Emotion enum to string
 QString emotionToString(Emotion emotion);
 
+// Outcome of analyzing a text
+struct EmotionResult {
+    Emotion emotion = Emotion::Neutral;
+    float confidence = 1.0f;                  // 0.0 to 1.0
+    std::array<int, kEmotionCount> scores{};  // Keyword matches, indexed by Emotion
+};
+
 // Emotion detection based on text analysis
+//
+// All state is built in the constructor and never modified afterwards, so
+// one detector can be shared by any number of threads.
 class EmotionDetector {
 public:
     EmotionDetector();
     ~EmotionDetector() = default;
 
+    // Analyze text (thread-safe)
+    EmotionResult analyze(const QString& text) const;
+
     // Analyze text and return detected emotion
-    Emotion detectEmotion(const QString& text) const;
+    Emotion detectEmotion(const QString& text) const { return analyze(text).emotion; }
+
+    // Confidence for an emotion with this many keyword matches (0.0 to 1.0)
+    static float confidenceForScore(int score);
+
+    // Compiled keyword lists (categories are Emotion values), for incremental scoring
+    const KeywordAutomaton& getKeywordAutomaton() const { return m_automaton; }
 
-    // Get confidence score for detected emotion (0.0 to 1.0)
-    float getConfidence() const { return m_lastConfidence; }
+    // Keyword lists as written ('*' suffix: also matches longer words)
+    const QMap<Emotion, QStringList>& getKeywordLists() const { return m_emotionKeywords; }
 
 private:
     void initializeKeywords();
-    int countKeywordMatches(const QString& text, const QStringList& keywords) const;
 
 private:
-    // Keyword lists for each emotion
+    // Keyword lists for each emotion ('*' suffix: also matches longer words)
     QMap<Emotion, QStringList> m_emotionKeywords;
-    mutable float m_lastConfidence;
+    KeywordAutomaton m_automaton;  // All keyword lists, compiled
 };
 
 } // namespace Chatbot
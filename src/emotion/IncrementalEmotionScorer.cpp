@@ -0,0 +1,91 @@
+#include "emotion/IncrementalEmotionScorer.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <utility>
+
+namespace Chatbot {
+
+IncrementalEmotionScorer::IncrementalEmotionScorer(std::shared_ptr<const EmotionDetector> detector,
+                                                   QObject *parent)
+    : QObject(parent)
+    , m_detector(std::move(detector))
+    , m_scores{}
+    , m_currentEmotion(Emotion::Neutral)
+    , m_margin(2)
+    , m_receivedText(false)
+    , m_reported(false)
+{
+}
+
+void IncrementalEmotionScorer::setHysteresis(int margin) {
+    m_margin = std::max(1, margin);
+}
+
+void IncrementalEmotionScorer::feed(const QString& chunk) {
+    if (chunk.isEmpty()) {
+        return;
+    }
+
+    m_receivedText = true;
+    m_detector->getKeywordAutomaton().scan(chunk, m_scanState, m_scores.data());
+    evaluate();
+}
+
+void IncrementalEmotionScorer::finish() {
+    m_detector->getKeywordAutomaton().finish(m_scanState, m_scores.data());
+    evaluate();
+
+    // A reply without emotional keywords still resets the expression
+    if (!m_reported) {
+        m_reported = true;
+        emit emotionDetected(m_currentEmotion, confidenceFor(m_currentEmotion));
+    }
+}
+
+void IncrementalEmotionScorer::reset() {
+    m_scanState = KeywordAutomaton::ScanState{};
+    m_scores.fill(0);
+    m_currentEmotion = Emotion::Neutral;
+    m_receivedText = false;
+    m_reported = false;
+}
+
+void IncrementalEmotionScorer::evaluate() {
+    // Leader so far (lowest enum value wins ties, as in detectEmotion)
+    Emotion leader = Emotion::Neutral;
+    int leaderScore = 0;
+    for (int i = 0; i < kEmotionCount; ++i) {
+        if (m_scores[i] > leaderScore) {
+            leaderScore = m_scores[i];
+            leader = static_cast<Emotion>(i);
+        }
+    }
+
+    if (leader == m_currentEmotion) {
+        return;
+    }
+
+    // Leaving Neutral takes one match; switching emotions takes a clear lead
+    int currentScore = m_scores[static_cast<int>(m_currentEmotion)];
+    int required = m_currentEmotion == Emotion::Neutral ? 1 : currentScore + m_margin;
+    if (leaderScore < required) {
+        return;
+    }
+
+    m_currentEmotion = leader;
+    m_reported = true;
+
+    float confidence = confidenceFor(leader);
+    spdlog::debug("Emotion changed to {} (score {}, confidence {:.2f})",
+                  emotionToString(leader).toStdString(), leaderScore, confidence);
+    emit emotionDetected(leader, confidence);
+}
+
+float IncrementalEmotionScorer::confidenceFor(Emotion emotion) const {
+    if (emotion == Emotion::Neutral) {
+        return 1.0f;  // High confidence in neutrality
+    }
+    return EmotionDetector::confidenceForScore(m_scores[static_cast<int>(emotion)]);
+}
+
+} // namespace Chatbot
@@ -0,0 +1,70 @@
+#ifndef CHATBOT_INCREMENTALEMOTIONSCORER_H
+#define CHATBOT_INCREMENTALEMOTIONSCORER_H
+
+#include "emotion/EmotionDetector.h"
+#include <QObject>
+#include <QString>
+#include <array>
+#include <memory>
+
+namespace Chatbot {
+
+/**
+ * IncrementalEmotionScorer follows the emotion of a reply while it streams
+ * in. Each chunk continues the keyword scan where the previous one stopped
+ * and updates running per-emotion counts, so the work per chunk depends only
+ * on the chunk. The dominant emotion only changes with hysteresis: another
+ * emotion must lead the current one by a margin, so the expression doesn't
+ * flicker between close scores.
+ */
+class IncrementalEmotionScorer : public QObject {
+    Q_OBJECT
+
+public:
+    // The detector provides the compiled keyword lists
+    explicit IncrementalEmotionScorer(std::shared_ptr<const EmotionDetector> detector,
+                                      QObject *parent = nullptr);
+    ~IncrementalEmotionScorer() override = default;
+
+    // Delete copy constructor and assignment operator
+    IncrementalEmotionScorer(const IncrementalEmotionScorer&) = delete;
+    IncrementalEmotionScorer& operator=(const IncrementalEmotionScorer&) = delete;
+
+    // Matches another emotion needs over the current one to take over (default 2)
+    void setHysteresis(int margin);
+
+    // Score the next piece of the reply
+    void feed(const QString& chunk);
+
+    // End of the reply: scores a keyword at the very end and reports the
+    // final emotion if none was reported during the reply
+    void finish();
+
+    // Start a new reply (current emotion back to Neutral)
+    void reset();
+
+    Emotion currentEmotion() const { return m_currentEmotion; }
+    bool hasReceivedText() const { return m_receivedText; }
+
+signals:
+    // Emitted when the dominant emotion changes (and once at finish())
+    void emotionDetected(Emotion emotion, float confidence);
+
+private:
+    void evaluate();
+    float confidenceFor(Emotion emotion) const;
+
+private:
+    std::shared_ptr<const EmotionDetector> m_detector;
+    KeywordAutomaton::ScanState m_scanState;
+    std::array<int, kEmotionCount> m_scores;  // Matches so far, indexed by Emotion
+
+    Emotion m_currentEmotion;
+    int m_margin;
+    bool m_receivedText;
+    bool m_reported;  // emotionDetected emitted for this reply
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_INCREMENTALEMOTIONSCORER_H
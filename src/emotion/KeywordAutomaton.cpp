@@ -0,0 +1,211 @@
+#include "emotion/KeywordAutomaton.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <deque>
+
+namespace Chatbot {
+
+namespace {
+
+// Typographic apostrophes are read as the ASCII one ("can’t" == "can't")
+QChar normalizeChar(QChar c) {
+    if (c == QChar(0x2019) || c == QChar(0x2018)) {
+        return QChar('\'');
+    }
+    return c.toLower();
+}
+
+bool isWordChar(QChar c) {
+    return c.isLetterOrNumber() || c == QChar('\'');
+}
+
+} // namespace
+
+KeywordAutomaton::KeywordAutomaton()
+    : m_categoryCount(0)
+    , m_built(false)
+    , m_alphabetSize(2)
+{
+    m_asciiSymbols.fill(kBoundarySymbol);
+}
+
+void KeywordAutomaton::addKeyword(const QString& keyword, int category) {
+    QString text = keyword.trimmed();
+    if (text.isEmpty() || category < 0) {
+        return;
+    }
+
+    Keyword entry;
+    entry.text.reserve(text.size());
+    for (QChar c : text) {
+        entry.text.append(normalizeChar(c));
+    }
+    entry.category = category;
+    m_keywords.push_back(entry);
+
+    m_categoryCount = std::max(m_categoryCount, category + 1);
+    m_built = false;
+}
+
+void KeywordAutomaton::build() {
+    // Alphabet: every character used in a keyword gets its own symbol
+    m_asciiSymbols.fill(kBoundarySymbol);
+    m_otherSymbols.clear();
+    m_alphabetSize = 2;
+
+    for (int c = 0; c < 128; ++c) {
+        if (isWordChar(QChar(c))) {
+            m_asciiSymbols[c] = kOtherWordSymbol;
+        }
+    }
+    for (const Keyword& keyword : m_keywords) {
+        for (QChar c : keyword.text) {
+            if (!isWordChar(c)) {
+                continue;  // Spaces and punctuation inside keywords are boundaries
+            }
+            if (c.unicode() < 128) {
+                if (m_asciiSymbols[c.unicode()] == kOtherWordSymbol) {
+                    m_asciiSymbols[c.unicode()] = m_alphabetSize++;
+                }
+            } else if (!m_otherSymbols.contains(c.unicode())) {
+                m_otherSymbols.insert(c.unicode(), m_alphabetSize++);
+            }
+        }
+    }
+
+    // Trie of boundary-wrapped patterns
+    m_transitions.assign(m_alphabetSize, -1);
+    m_outputs.assign(1, {});
+
+    for (const Keyword& keyword : m_keywords) {
+        QString text = keyword.text;
+        bool prefixOnly = text.endsWith('*');
+        if (prefixOnly) {
+            text.chop(1);
+        }
+
+        std::vector<int> pattern;
+        pattern.push_back(kBoundarySymbol);
+        for (QChar c : text) {
+            pattern.push_back(symbolFor(c));
+        }
+        if (!prefixOnly) {
+            pattern.push_back(kBoundarySymbol);
+        }
+
+        int node = 0;
+        for (int symbol : pattern) {
+            int& next = m_transitions[static_cast<size_t>(node * m_alphabetSize + symbol)];
+            if (next == -1) {
+                next = static_cast<int>(m_outputs.size());
+                m_outputs.emplace_back();
+                m_transitions.resize(m_transitions.size() + m_alphabetSize, -1);
+            }
+            node = m_transitions[static_cast<size_t>(node * m_alphabetSize + symbol)];
+        }
+        m_outputs[static_cast<size_t>(node)].push_back(keyword.category);
+    }
+
+    // Breadth-first: failure links, folded into a complete transition table
+    std::vector<int> failure(m_outputs.size(), 0);
+    std::deque<int> queue;
+    for (int symbol = 0; symbol < m_alphabetSize; ++symbol) {
+        int& next = m_transitions[static_cast<size_t>(symbol)];
+        if (next == -1) {
+            next = 0;
+        } else {
+            failure[static_cast<size_t>(next)] = 0;
+            queue.push_back(next);
+        }
+    }
+
+    while (!queue.empty()) {
+        int node = queue.front();
+        queue.pop_front();
+
+        // Matches ending at the failure node also end here
+        const std::vector<int>& inherited = m_outputs[static_cast<size_t>(failure[static_cast<size_t>(node)])];
+        std::vector<int>& outputs = m_outputs[static_cast<size_t>(node)];
+        outputs.insert(outputs.end(), inherited.begin(), inherited.end());
+
+        for (int symbol = 0; symbol < m_alphabetSize; ++symbol) {
+            size_t index = static_cast<size_t>(node * m_alphabetSize + symbol);
+            int fallback = m_transitions[static_cast<size_t>(failure[static_cast<size_t>(node)] * m_alphabetSize + symbol)];
+            if (m_transitions[index] == -1) {
+                m_transitions[index] = fallback;
+            } else {
+                failure[static_cast<size_t>(m_transitions[index])] = fallback;
+                queue.push_back(m_transitions[index]);
+            }
+        }
+    }
+
+    m_built = true;
+    spdlog::debug("Keyword automaton built: {} keywords, {} nodes, {} symbols",
+                  m_keywords.size(), m_outputs.size(), m_alphabetSize);
+}
+
+int KeywordAutomaton::symbolFor(QChar c) const {
+    c = normalizeChar(c);
+    if (c.unicode() < 128) {
+        return m_asciiSymbols[c.unicode()];
+    }
+    if (!isWordChar(c)) {
+        return kBoundarySymbol;
+    }
+    return m_otherSymbols.value(c.unicode(), kOtherWordSymbol);
+}
+
+int KeywordAutomaton::step(int node, int symbol, int* counts) const {
+    node = m_transitions[static_cast<size_t>(node * m_alphabetSize + symbol)];
+    for (int category : m_outputs[static_cast<size_t>(node)]) {
+        counts[category]++;
+    }
+    return node;
+}
+
+void KeywordAutomaton::scan(const QString& text, ScanState& state, int* counts) const {
+    if (!m_built) {
+        return;
+    }
+
+    // Start of text counts as a boundary
+    int node = state.node;
+    bool atBoundary = state.atBoundary;
+    if (node < 0) {
+        node = step(0, kBoundarySymbol, counts);
+        atBoundary = true;
+    }
+
+    for (QChar c : text) {
+        int symbol = symbolFor(c);
+        bool boundary = symbol == kBoundarySymbol;
+        if (!(boundary && atBoundary)) {
+            node = step(node, symbol, counts);
+        }
+        atBoundary = boundary;
+    }
+
+    state.node = node;
+    state.atBoundary = atBoundary;
+}
+
+void KeywordAutomaton::finish(ScanState& state, int* counts) const {
+    if (!m_built || state.node < 0) {
+        return;
+    }
+
+    // End of text counts as a boundary
+    if (!state.atBoundary) {
+        step(state.node, kBoundarySymbol, counts);
+    }
+    state = ScanState{};
+}
+
+void KeywordAutomaton::count(const QString& text, int* counts) const {
+    ScanState state;
+    scan(text, state, counts);
+    finish(state, counts);
+}
+
+} // namespace Chatbot
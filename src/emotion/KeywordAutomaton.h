@@ -0,0 +1,86 @@
+#ifndef CHATBOT_KEYWORDAUTOMATON_H
+#define CHATBOT_KEYWORDAUTOMATON_H
+
+#include <QString>
+#include <QChar>
+#include <QHash>
+#include <array>
+#include <vector>
+
+namespace Chatbot {
+
+/**
+ * KeywordAutomaton finds whole-word keyword matches for many keywords in a
+ * single pass over the text (Aho-Corasick). Each keyword belongs to a
+ * category; scanning adds up matches per category.
+ *
+ * Word boundaries are part of the patterns: every character that isn't a
+ * letter, digit or apostrophe is read as one boundary symbol, and keywords
+ * are compiled as <boundary>keyword<boundary>, so "good" doesn't match in
+ * "goodbye"; runs of boundary characters count as one. A keyword ending in '*' only needs the leading boundary
+ * ("concern*" matches "concerned"). Matching is case-insensitive.
+ *
+ * Text can be scanned in pieces by carrying a ScanState along; a compiled
+ * automaton is immutable and can be shared between threads.
+ */
+class KeywordAutomaton {
+public:
+    // Position in the automaton between two pieces of text
+    struct ScanState {
+        int node = -1;            // -1: nothing scanned yet
+        bool atBoundary = false;  // Last character was a boundary
+    };
+
+    KeywordAutomaton();
+    ~KeywordAutomaton() = default;
+
+    // Add keywords, then build() before scanning
+    void addKeyword(const QString& keyword, int category);
+    void build();
+
+    bool isBuilt() const { return m_built; }
+    int categoryCount() const { return m_categoryCount; }
+    int nodeCount() const { return static_cast<int>(m_outputs.size()); }
+
+    // Scan a piece of text, adding matches to counts[category]; counts must
+    // have categoryCount() entries
+    void scan(const QString& text, ScanState& state, int* counts) const;
+
+    // End of text (completes keywords at the very end)
+    void finish(ScanState& state, int* counts) const;
+
+    // Scan a complete text
+    void count(const QString& text, int* counts) const;
+
+private:
+    struct Keyword {
+        QString text;
+        int category;
+    };
+
+    int symbolFor(QChar c) const;
+    int step(int node, int symbol, int* counts) const;
+
+private:
+    // Symbols 0 and 1 are reserved; keyword characters start at 2
+    static constexpr int kBoundarySymbol = 0;
+    static constexpr int kOtherWordSymbol = 1;  // Letter/digit that's in no keyword
+
+    std::vector<Keyword> m_keywords;
+    int m_categoryCount;
+    bool m_built;
+
+    // Character classes
+    std::array<int, 128> m_asciiSymbols;
+    QHash<char16_t, int> m_otherSymbols;  // Non-ASCII keyword characters
+    int m_alphabetSize;
+
+    // Dense goto table (node * m_alphabetSize + symbol), failure links folded in
+    std::vector<int> m_transitions;
+    // Categories matched on entering a node, including those of its suffixes
+    std::vector<std::vector<int>> m_outputs;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_KEYWORDAUTOMATON_H
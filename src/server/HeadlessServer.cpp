@@ -0,0 +1,377 @@
+#include "server/HeadlessServer.h"
+#include "avatar/VisemeMapper.h"
+#include "avatar/VisemeTrack.h"
+#include "chat/ChatEngine.h"
+#include "chat/ChatSession.h"
+#include "personality/PersonalityManager.h"
+#include "tts/PiperWorker.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QtEndian>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <optional>
+
+using json = nlohmann::json;
+
+namespace Chatbot {
+
+namespace {
+const QString kPiperPath = "./third_party/piper/piper";
+const QString kModelPath = "./third_party/voices/en_US-lessac-medium.onnx";
+
+constexpr char kJsonFrame = 'J';
+constexpr char kAudioFrame = 'A';
+constexpr quint32 kMaxFrameSize = 1 << 20;  // Client frames are small JSON requests
+
+// A request field that must be a string; nullopt if missing or of another type
+std::optional<QString> stringField(const json& request, const char* key) {
+    auto it = request.find(key);
+    if (it == request.end() || !it->is_string()) {
+        return std::nullopt;
+    }
+    return QString::fromStdString(it->get<std::string>());
+}
+}
+
+HeadlessServer::HeadlessServer(QObject *parent)
+    : QObject(parent)
+    , m_server(new QLocalServer(this))
+    , m_chatEngine(std::make_unique<ChatEngine>())
+    , m_piperWorker(std::make_unique<PiperWorker>())
+    , m_visemeMapper(std::make_unique<VisemeMapper>())
+    , m_personalityManager(std::make_unique<PersonalityManager>())
+    , m_sampleRate(22050)
+    , m_nextClientId(1)
+{
+    m_visemeMapper->loadMapping("./config/viseme_mapping.json");
+    m_personalityManager->loadPersonalities();
+
+    // Alignment gives the viseme timing without a separate phonemizer pass
+    m_piperWorker->setPiperPath(kPiperPath);
+    m_piperWorker->setModelPath(kModelPath);
+    m_piperWorker->setReportPhonemes(true);
+    m_sampleRate = PiperWorker::readSampleRate(kModelPath).value_or(m_sampleRate);
+
+    connect(m_piperWorker.get(), &PiperWorker::audioChunk, this, &HeadlessServer::onAudioChunk);
+    connect(m_piperWorker.get(), &PiperWorker::phonemesAligned, this, &HeadlessServer::onPhonemesAligned);
+    connect(m_piperWorker.get(), &PiperWorker::synthesisFinished, this, &HeadlessServer::onSynthesisFinished);
+    connect(m_server, &QLocalServer::newConnection, this, &HeadlessServer::onNewConnection);
+}
+
+HeadlessServer::~HeadlessServer() {
+    m_server->close();
+    spdlog::info("Headless server stopped");
+}
+
+bool HeadlessServer::listen(const QString& name) {
+    // A previous instance that crashed may have left its socket file behind
+    QLocalServer::removeServer(name);
+
+    if (!m_server->listen(name)) {
+        spdlog::error("Failed to listen on {}: {}", name.toStdString(), m_server->errorString().toStdString());
+        return false;
+    }
+
+    m_piperWorker->start();
+    m_chatEngine->preloadModel();
+    spdlog::info("Headless server listening on {}", m_server->fullServerName().toStdString());
+    return true;
+}
+
+void HeadlessServer::onNewConnection() {
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        auto client = std::make_unique<Client>();
+        client->id = m_nextClientId++;
+        client->socket = socket;
+        client->session = m_chatEngine->session(QString("client-%1").arg(client->id));
+
+        Personality personality = m_personalityManager->getCurrentPersonality();
+        client->session->setSystemPrompt(personality.systemPrompt);
+        client->session->setPersonality(m_personalityManager->getCurrentPersonalityName());
+
+        quint64 id = client->id;
+        connect(socket, &QLocalSocket::readyRead, this, [this, id]() {
+            if (Client* client = findClient(id)) {
+                onReadyRead(*client);
+            }
+        });
+        // Queued: the socket can disconnect while one of its requests is being
+        // handled, which must not delete the client underneath it
+        connect(socket, &QLocalSocket::disconnected, this, [this, id]() {
+            removeClient(id);
+        }, Qt::QueuedConnection);
+
+        Client& added = *client;
+        m_clients.emplace(id, std::move(client));
+        connectSession(added);
+        spdlog::info("Client {} connected ({} clients)", id, m_clients.size());
+
+        json visemes = json::array();
+        for (int i = 0; i < m_visemeMapper->visemeCount(); ++i) {
+            visemes.push_back(m_visemeMapper->visemeAt(i).name.toStdString());
+        }
+        sendJson(added, {
+            {"event", "ready"},
+            {"session", added.session->id().toStdString()},
+            {"sampleRate", m_sampleRate},
+            {"visemes", visemes}
+        });
+    }
+}
+
+void HeadlessServer::connectSession(Client& client) {
+    quint64 id = client.id;
+    ChatSession* session = client.session;
+
+    connect(session, &ChatSession::partialResponseReceived, this, [this, id](const QString& delta) {
+        Client* client = findClient(id);
+        if (!client) {
+            return;
+        }
+        sendJson(*client, {{"event", "delta"}, {"text", delta.toStdString()}});
+        for (const QString& sentence : client->splitter.feed(delta)) {
+            speak(*client, sentence);
+        }
+    });
+
+    connect(session, &ChatSession::responseReceived, this, [this, id](const QString& response) {
+        Client* client = findClient(id);
+        if (!client) {
+            return;
+        }
+        sendJson(*client, {{"event", "reply"}, {"text", response.toStdString()}});
+
+        // Without streaming the whole reply arrives here at once
+        if (!client->splitter.hasReceivedText()) {
+            for (const QString& sentence : client->splitter.feed(response)) {
+                speak(*client, sentence);
+            }
+        }
+        QString remainder = client->splitter.flush();
+        if (!remainder.trimmed().isEmpty()) {
+            speak(*client, remainder);
+        }
+    });
+
+    connect(session, &ChatSession::errorOccurred, this, [this, id](const QString& error) {
+        if (Client* client = findClient(id)) {
+            sendJson(*client, {{"event", "error"}, {"message", error.toStdString()}});
+        }
+    });
+
+    connect(session, &ChatSession::requestCancelled, this, [this, id]() {
+        if (Client* client = findClient(id)) {
+            cancelSpeech(*client);
+            client->turnActive = false;
+            sendJson(*client, {{"event", "cancelled"}});
+        }
+    });
+
+    connect(session, &ChatSession::processingFinished, this, [this, id]() {
+        if (Client* client = findClient(id)) {
+            client->replyComplete = true;
+            finishTurnIfDone(*client);
+        }
+    });
+}
+
+void HeadlessServer::onReadyRead(Client& client) {
+    client.readBuffer += client.socket->readAll();
+
+    // Frames left after a disconnect are dropped
+    while (client.readBuffer.size() >= 4 && client.socket->state() == QLocalSocket::ConnectedState) {
+        quint32 length = qFromBigEndian<quint32>(client.readBuffer.constData());
+        if (length == 0 || length > kMaxFrameSize) {
+            spdlog::warn("Client {} sent an invalid frame ({} bytes), disconnecting", client.id, length);
+            client.socket->disconnectFromServer();
+            return;
+        }
+        if (static_cast<quint32>(client.readBuffer.size()) < 4 + length) {
+            return;  // Rest of the frame still in transit
+        }
+
+        char type = client.readBuffer.at(4);
+        QByteArray payload = client.readBuffer.mid(5, static_cast<int>(length) - 1);
+        client.readBuffer.remove(0, 4 + static_cast<int>(length));
+
+        if (type != kJsonFrame) {
+            sendJson(client, {{"event", "error"}, {"message", "Unsupported frame type"}});
+            continue;
+        }
+
+        json request = json::parse(payload.constData(), payload.constData() + payload.size(), nullptr, false);
+        if (request.is_discarded() || !request.is_object()) {
+            sendJson(client, {{"event", "error"}, {"message", "Malformed request"}});
+            continue;
+        }
+        handleRequest(client, request);
+    }
+}
+
+void HeadlessServer::handleRequest(Client& client, const json& request) {
+    // Fields of the wrong type would otherwise throw out of the event loop
+    std::optional<QString> type = stringField(request, "type");
+    std::optional<QString> text = stringField(request, "text");
+    std::optional<QString> name = stringField(request, "name");
+    if (!type || (*type == "message" && !text) || (*type == "personality" && !name)) {
+        sendJson(client, {{"event", "error"}, {"message", "Malformed request"}});
+        return;
+    }
+
+    if (*type == "message") {
+        // A new message replaces the current turn, speech included
+        cancelSpeech(client);
+        client.audioBytes = 0;
+        client.session->sendMessage(*text);
+
+        // Rejected messages were already answered with an error
+        if (client.session->isProcessing()) {
+            client.turnActive = true;
+            client.replyComplete = false;
+        }
+    } else if (*type == "cancel") {
+        if (client.session->isProcessing()) {
+            client.session->cancelRequest();  // Stops speech too (requestCancelled)
+        } else if (client.turnActive) {
+            cancelSpeech(client);
+            client.turnActive = false;
+            sendJson(client, {{"event", "cancelled"}});
+        }
+    } else if (*type == "personality") {
+        if (!m_personalityManager->getAvailablePersonalities().contains(*name)) {
+            sendJson(client, {{"event", "error"}, {"message", "Unknown personality"}});
+            return;
+        }
+        client.session->setSystemPrompt(m_personalityManager->getPersonality(*name).systemPrompt);
+        client.session->setPersonality(*name);
+        sendJson(client, {{"event", "personality"}, {"name", name->toStdString()}});
+    } else {
+        sendJson(client, {{"event", "error"}, {"message", "Unknown request type"}});
+    }
+}
+
+void HeadlessServer::speak(Client& client, const QString& text) {
+    quint64 requestId = m_piperWorker->synthesize(text);
+
+    Utterance utterance;
+    utterance.clientId = client.id;
+    utterance.text = text;
+    m_utterances.insert(requestId, utterance);
+    client.utterances.push_back(requestId);
+}
+
+void HeadlessServer::cancelSpeech(Client& client) {
+    for (quint64 requestId : client.utterances) {
+        m_piperWorker->cancel(requestId);
+        m_utterances.remove(requestId);
+    }
+    client.utterances.clear();
+    client.splitter.reset();
+}
+
+void HeadlessServer::onAudioChunk(quint64 requestId, const QByteArray& pcm) {
+    auto it = m_utterances.find(requestId);
+    if (it == m_utterances.end()) {
+        return;
+    }
+    Client* client = findClient(it->clientId);
+    if (!client) {
+        return;
+    }
+
+    // Piper works through requests in order, so each client's audio is contiguous
+    if (it->startByte < 0) {
+        it->startByte = client->audioBytes;
+    }
+    it->bytes += pcm.size();
+    client->audioBytes += pcm.size();
+    sendFrame(*client, kAudioFrame, pcm);
+}
+
+void HeadlessServer::onPhonemesAligned(quint64 requestId, const PhonemeAlignment& alignment) {
+    auto it = m_utterances.find(requestId);
+    if (it == m_utterances.end()) {
+        return;
+    }
+
+    it->alignment = alignment;
+    for (AlignedSentence& sentence : it->alignment.sentences) {
+        approximateSamplesPerId(sentence, m_sampleRate);
+    }
+}
+
+void HeadlessServer::onSynthesisFinished(quint64 requestId, bool success) {
+    if (!m_utterances.contains(requestId)) {
+        return;
+    }
+    Utterance utterance = m_utterances.take(requestId);
+    Client* client = findClient(utterance.clientId);
+    if (!client) {
+        return;
+    }
+
+    auto& pending = client->utterances;
+    pending.erase(std::remove(pending.begin(), pending.end(), requestId), pending.end());
+
+    if (!success) {
+        sendJson(*client, {{"event", "error"}, {"message", "Failed to generate audio"}});
+    } else if (!utterance.alignment.isEmpty() && utterance.startByte >= 0) {
+        PhonemeTimeline timeline = buildPiperTimeline(utterance.alignment, utterance.text,
+                                                      utterance.bytes / 2, m_sampleRate);
+        double offset = static_cast<double>(utterance.startByte) / (m_sampleRate * 2.0);
+
+        VisemeTrack track;
+        track.append(timeline, offset, *m_visemeMapper);
+
+        json keys = json::array();
+        for (size_t i = 0; i < track.keyCount(); ++i) {
+            keys.push_back({track.keyStart(i), track.keyEnd(i),
+                            m_visemeMapper->visemeAt(track.keyViseme(i)).name.toStdString()});
+        }
+        sendJson(*client, {{"event", "visemes"}, {"text", utterance.text.toStdString()}, {"keys", keys}});
+    }
+
+    finishTurnIfDone(*client);
+}
+
+void HeadlessServer::finishTurnIfDone(Client& client) {
+    if (client.turnActive && client.replyComplete && client.utterances.empty()) {
+        client.turnActive = false;
+        sendJson(client, {{"event", "done"}});
+    }
+}
+
+void HeadlessServer::removeClient(quint64 clientId) {
+    auto it = m_clients.find(clientId);
+    if (it == m_clients.end()) {
+        return;
+    }
+
+    Client& client = *it->second;
+    cancelSpeech(client);
+    m_chatEngine->removeSession(client.session->id());
+    client.socket->deleteLater();
+    m_clients.erase(it);
+    spdlog::info("Client {} disconnected ({} clients)", clientId, m_clients.size());
+}
+
+HeadlessServer::Client* HeadlessServer::findClient(quint64 clientId) {
+    auto it = m_clients.find(clientId);
+    return it != m_clients.end() ? it->second.get() : nullptr;
+}
+
+void HeadlessServer::sendJson(Client& client, const json& event) {
+    sendFrame(client, kJsonFrame, QByteArray::fromStdString(event.dump()));
+}
+
+void HeadlessServer::sendFrame(Client& client, char type, const QByteArray& payload) {
+    char header[5];
+    qToBigEndian<quint32>(static_cast<quint32>(payload.size() + 1), header);
+    header[4] = type;
+
+    client.socket->write(header, sizeof(header));
+    client.socket->write(payload);
+}
+
+} // namespace Chatbot
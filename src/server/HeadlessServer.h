@@ -0,0 +1,115 @@
+#ifndef CHATBOT_HEADLESSSERVER_H
+#define CHATBOT_HEADLESSSERVER_H
+
+#include "tts/PhonemeTimeline.h"
+#include "tts/SentenceSplitter.h"
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <nlohmann/json.hpp>
+#include <map>
+#include <memory>
+#include <vector>
+
+class QLocalServer;
+class QLocalSocket;
+
+namespace Chatbot {
+
+class ChatEngine;
+class ChatSession;
+class PiperWorker;
+class VisemeMapper;
+class PersonalityManager;
+
+/**
+ * HeadlessServer runs the chat -> TTS -> viseme pipeline without any UI and
+ * serves it over a local socket (a Unix domain socket on Linux/macOS, a
+ * named pipe on Windows). Each connection is its own chat session.
+ *
+ * Frames in both directions are a 4-byte big-endian length (of what
+ * follows), a 1-byte type and the payload:
+ *   'J'  UTF-8 JSON object
+ *   'A'  Raw 16-bit mono PCM (server to client), at the sample rate sent
+ *        in the "ready" event
+ *
+ * Client requests:
+ *   {"type": "message", "text": "..."}        Interrupts the reply in progress
+ *   {"type": "cancel"}
+ *   {"type": "personality", "name": "..."}
+ *
+ * Server events, per turn: "delta" (text chunks), "visemes" (per sentence,
+ * keys as [start, end, viseme] in seconds of the turn's audio, offset
+ * already applied), "reply" (full text), then "done" once all audio was
+ * sent; or "cancelled" / "error".
+ */
+class HeadlessServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit HeadlessServer(QObject *parent = nullptr);
+    ~HeadlessServer() override;
+
+    // Delete copy constructor and assignment operator
+    HeadlessServer(const HeadlessServer&) = delete;
+    HeadlessServer& operator=(const HeadlessServer&) = delete;
+
+    // Start accepting connections on a socket name or path
+    bool listen(const QString& name);
+
+private slots:
+    void onNewConnection();
+    void onAudioChunk(quint64 requestId, const QByteArray& pcm);
+    void onPhonemesAligned(quint64 requestId, const PhonemeAlignment& alignment);
+    void onSynthesisFinished(quint64 requestId, bool success);
+
+private:
+    struct Client {
+        quint64 id = 0;
+        QLocalSocket* socket = nullptr;
+        ChatSession* session = nullptr;
+        QByteArray readBuffer;
+        SentenceSplitter splitter;
+        std::vector<quint64> utterances;  // Piper requests of this turn, in order
+        qint64 audioBytes = 0;            // PCM sent this turn
+        bool turnActive = false;          // A message is being answered or spoken
+        bool replyComplete = true;
+    };
+
+    struct Utterance {
+        quint64 clientId = 0;
+        QString text;
+        qint64 startByte = -1;  // Turn audio position of the first chunk
+        qint64 bytes = 0;
+        PhonemeAlignment alignment;
+    };
+
+    void connectSession(Client& client);
+    void onReadyRead(Client& client);
+    void handleRequest(Client& client, const nlohmann::json& request);
+    void speak(Client& client, const QString& text);
+    void cancelSpeech(Client& client);
+    void finishTurnIfDone(Client& client);
+    void removeClient(quint64 clientId);
+    Client* findClient(quint64 clientId);
+
+    void sendJson(Client& client, const nlohmann::json& event);
+    void sendFrame(Client& client, char type, const QByteArray& payload);
+
+private:
+    QLocalServer* m_server;
+    std::unique_ptr<ChatEngine> m_chatEngine;
+    std::unique_ptr<PiperWorker> m_piperWorker;
+    std::unique_ptr<VisemeMapper> m_visemeMapper;
+    std::unique_ptr<PersonalityManager> m_personalityManager;
+    int m_sampleRate;
+
+    std::map<quint64, std::unique_ptr<Client>> m_clients;
+    QHash<quint64, Utterance> m_utterances;  // By Piper request ID
+    quint64 m_nextClientId;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_HEADLESSSERVER_H
@@ -0,0 +1,63 @@
+#include "tts/AudioClock.h"
+#include <algorithm>
+
+namespace Chatbot {
+
+namespace {
+// Don't extrapolate further than this past the last report (seconds); if the
+// sink stops reporting, it has most likely stalled
+constexpr double kMaxExtrapolation = 0.25;
+}
+
+AudioClock::AudioClock()
+    : m_anchorPosition(0.0)
+    , m_anchorTime(0)
+    , m_writtenSeconds(0.0)
+    , m_lastPosition(0.0)
+    , m_running(false)
+{
+}
+
+void AudioClock::start() {
+    m_timer.start();
+    m_anchorPosition = 0.0;
+    m_anchorTime = 0;
+    m_writtenSeconds = 0.0;
+    m_lastPosition = 0.0;
+    m_running = true;
+}
+
+void AudioClock::stop() {
+    m_running = false;
+    m_lastPosition = 0.0;
+}
+
+void AudioClock::sync(double playedSeconds, double writtenSeconds) {
+    if (!m_running) {
+        return;
+    }
+
+    m_writtenSeconds = writtenSeconds;
+
+    // Only re-anchor when the sink actually advanced, otherwise the
+    // extrapolation would restart from the same stale value every call
+    if (playedSeconds != m_anchorPosition) {
+        m_anchorPosition = playedSeconds;
+        m_anchorTime = m_timer.nsecsElapsed();
+    }
+}
+
+double AudioClock::now() {
+    if (!m_running) {
+        return 0.0;
+    }
+
+    double elapsed = (m_timer.nsecsElapsed() - m_anchorTime) / 1e9;
+    double position = m_anchorPosition + std::min(elapsed, kMaxExtrapolation);
+
+    position = std::min(position, m_writtenSeconds);
+    m_lastPosition = std::max(position, m_lastPosition);
+    return m_lastPosition;
+}
+
+} // namespace Chatbot
@@ -0,0 +1,43 @@
+#ifndef CHATBOT_AUDIOCLOCK_H
+#define CHATBOT_AUDIOCLOCK_H
+
+#include <QElapsedTimer>
+
+namespace Chatbot {
+
+/**
+ * AudioClock tells the playback position at any moment, not just when the
+ * audio sink reports progress. The sink's processed-sample count advances in
+ * steps of its period size (tens of milliseconds on most backends); between
+ * reports the position is extrapolated with a monotonic timer, so per-frame
+ * readers see smooth time. The clock never runs backwards and never passes
+ * the audio actually handed to the sink, so it holds still on underruns.
+ */
+class AudioClock {
+public:
+    AudioClock();
+    ~AudioClock() = default;
+
+    // Start at position 0 (when the audio sink is started)
+    void start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    // Report the sink's progress: seconds played so far, and seconds written to it
+    void sync(double playedSeconds, double writtenSeconds);
+
+    // Interpolated playback position in seconds
+    double now();
+
+private:
+    QElapsedTimer m_timer;
+    double m_anchorPosition;   // Last reported sink position
+    qint64 m_anchorTime;       // m_timer time of that report (ns)
+    double m_writtenSeconds;
+    double m_lastPosition;     // Last value returned by now()
+    bool m_running;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_AUDIOCLOCK_H
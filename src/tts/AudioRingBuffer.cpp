@@ -0,0 +1,86 @@
+#include "tts/AudioRingBuffer.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+
+namespace Chatbot {
+
+AudioRingBuffer::AudioRingBuffer(qint64 initialCapacity)
+    : m_data(static_cast<size_t>(std::max<qint64>(initialCapacity, 1)))
+    , m_readPos(0)
+    , m_size(0)
+{
+}
+
+void AudioRingBuffer::write(const char* data, qint64 size) {
+    if (size <= 0) {
+        return;
+    }
+
+    if (m_size + size > capacity()) {
+        grow(m_size + size);
+    }
+
+    // Copy in up to two pieces: to the end of storage, then wrapped to the start
+    const qint64 cap = capacity();
+    qint64 writePos = (m_readPos + m_size) % cap;
+    qint64 first = std::min(size, cap - writePos);
+    std::memcpy(m_data.data() + writePos, data, static_cast<size_t>(first));
+    std::memcpy(m_data.data(), data + first, static_cast<size_t>(size - first));
+
+    m_size += size;
+}
+
+qint64 AudioRingBuffer::read(char* data, qint64 maxSize) {
+    qint64 count = peek(data, maxSize);
+    discard(count);
+    return count;
+}
+
+qint64 AudioRingBuffer::peek(char* data, qint64 maxSize) const {
+    qint64 count = std::min(maxSize, m_size);
+    if (count <= 0) {
+        return 0;
+    }
+
+    const qint64 cap = capacity();
+    qint64 first = std::min(count, cap - m_readPos);
+    std::memcpy(data, m_data.data() + m_readPos, static_cast<size_t>(first));
+    std::memcpy(data + first, m_data.data(), static_cast<size_t>(count - first));
+    return count;
+}
+
+void AudioRingBuffer::discard(qint64 size) {
+    size = std::min(size, m_size);
+    if (size <= 0) {
+        return;
+    }
+
+    m_readPos = (m_readPos + size) % capacity();
+    m_size -= size;
+}
+
+void AudioRingBuffer::clear() {
+    m_readPos = 0;
+    m_size = 0;
+}
+
+void AudioRingBuffer::grow(qint64 minimumCapacity) {
+    qint64 newCapacity = capacity();
+    while (newCapacity < minimumCapacity) {
+        newCapacity *= 2;
+    }
+
+    // Linearize the unread data at the start of the new storage
+    std::vector<char> newData(static_cast<size_t>(newCapacity));
+    qint64 size = m_size;
+    read(newData.data(), size);
+
+    m_data = std::move(newData);
+    m_readPos = 0;
+    m_size = size;
+
+    spdlog::debug("Audio ring buffer grown to {} bytes", newCapacity);
+}
+
+} // namespace Chatbot
@@ -0,0 +1,49 @@
+#ifndef CHATBOT_AUDIORINGBUFFER_H
+#define CHATBOT_AUDIORINGBUFFER_H
+
+#include <QtGlobal>
+#include <vector>
+
+namespace Chatbot {
+
+/**
+ * AudioRingBuffer holds synthesized PCM between Piper and the audio sink.
+ * Writes never fail: when full, the buffer grows (keeping the unread data
+ * in order), so a fast synthesizer can run ahead of playback.
+ * Not thread-safe; producer and consumer both live on the TTSEngine thread.
+ */
+class AudioRingBuffer {
+public:
+    explicit AudioRingBuffer(qint64 initialCapacity = 1 << 20);  // 1 MB (~24s at 22050 Hz)
+    ~AudioRingBuffer() = default;
+
+    // Append bytes
+    void write(const char* data, qint64 size);
+
+    // Copy up to maxSize bytes out of the buffer, returns the number copied
+    qint64 read(char* data, qint64 maxSize);
+
+    // Like read(), without consuming; follow with discard() for what was used
+    qint64 peek(char* data, qint64 maxSize) const;
+    void discard(qint64 size);
+
+    // Bytes waiting to be read
+    qint64 available() const { return m_size; }
+    qint64 capacity() const { return static_cast<qint64>(m_data.size()); }
+    bool isEmpty() const { return m_size == 0; }
+
+    // Drop all unread data
+    void clear();
+
+private:
+    void grow(qint64 minimumCapacity);
+
+private:
+    std::vector<char> m_data;
+    qint64 m_readPos;
+    qint64 m_size;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_AUDIORINGBUFFER_H
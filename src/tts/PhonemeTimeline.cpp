@@ -0,0 +1,130 @@
+#include "tts/PhonemeTimeline.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Chatbot {
+
+namespace {
+
+// Reserved IDs in every Piper voice's phoneme_id_map
+constexpr int kPadId = 0;  // "_", interleaved after every phoneme
+constexpr int kBosId = 1;  // "^"
+constexpr int kEosId = 2;  // "$"
+
+// Relative duration of an ID, by the class of phoneme it encodes
+double idWeight(int id, char32_t symbol) {
+    static const std::u32string vowels = U"aeiouyæɑɐɒɔəɚɛɜɞɘɤɨɪɯɵøœʉʊʌʏ";
+    static const std::u32string marks = U"ˈˌːˑ";
+    static const std::u32string pauses = U",.;:!?";
+
+    if (id == kPadId) return 0.35;
+    if (id == kBosId || id == kEosId) return 0.5;
+    if (marks.find(symbol) != std::u32string::npos) return 0.15;
+    if (symbol == U' ') return 0.5;
+    if (pauses.find(symbol) != std::u32string::npos) return 1.5;
+    if (vowels.find(symbol) != std::u32string::npos) return 1.6;
+    return 1.0;  // Consonants
+}
+
+bool isSpecialId(int id) {
+    return id == kPadId || id == kBosId || id == kEosId;
+}
+
+} // namespace
+
+void approximateSamplesPerId(AlignedSentence& sentence, int sampleRate) {
+    const std::vector<int>& ids = sentence.phonemeIds;
+    const QList<uint> symbols = sentence.phonemes.toUcs4();
+
+    // Assign each non-special ID the next phoneme symbol, in order
+    std::vector<double> weights;
+    weights.reserve(ids.size());
+    qsizetype symbolIndex = 0;
+    for (int id : ids) {
+        char32_t symbol = 0;
+        if (!isSpecialId(id) && symbolIndex < symbols.size()) {
+            symbol = symbols[symbolIndex++];
+        }
+        weights.push_back(idWeight(id, symbol));
+    }
+
+    double totalWeight = std::accumulate(weights.begin(), weights.end(), 0.0);
+    qint64 totalSamples = std::llround(sentence.audioSeconds * sampleRate);
+
+    // Distribute so the per-ID counts add up to exactly totalSamples
+    sentence.samplesPerId.assign(ids.size(), 0);
+    double cumulativeWeight = 0.0;
+    qint64 assigned = 0;
+    for (size_t i = 0; i < ids.size() && totalWeight > 0.0; ++i) {
+        cumulativeWeight += weights[i];
+        qint64 end = std::llround(totalSamples * cumulativeWeight / totalWeight);
+        sentence.samplesPerId[i] = static_cast<int>(end - assigned);
+        assigned = end;
+    }
+}
+
+PhonemeTimeline buildPiperTimeline(const PhonemeAlignment& alignment, const QString& text,
+                                   qint64 totalSamples, int sampleRate) {
+    PhonemeTimeline timeline;
+    timeline.text = text;
+    timeline.totalDuration = static_cast<double>(totalSamples) / sampleRate;
+
+    if (alignment.isEmpty() || sampleRate <= 0) {
+        return timeline;
+    }
+
+    // Piper appends the same silence after every sentence; whatever the
+    // sentences don't account for is that silence
+    qint64 sentenceSamples = 0;
+    for (const AlignedSentence& sentence : alignment.sentences) {
+        sentenceSamples += std::accumulate(sentence.samplesPerId.begin(), sentence.samplesPerId.end(), qint64{0});
+    }
+
+    double scale = 1.0;
+    qint64 silencePerSentence = 0;
+    if (sentenceSamples > totalSamples && sentenceSamples > 0) {
+        scale = static_cast<double>(totalSamples) / sentenceSamples;  // Rounding in reported durations
+    } else {
+        silencePerSentence = (totalSamples - sentenceSamples) / static_cast<qint64>(alignment.sentences.size());
+    }
+
+    double position = 0.0;  // Samples
+    for (const AlignedSentence& sentence : alignment.sentences) {
+        const QList<uint> symbols = sentence.phonemes.toUcs4();
+        qsizetype symbolIndex = 0;
+
+        for (size_t i = 0; i < sentence.phonemeIds.size(); ++i) {
+            int id = sentence.phonemeIds[i];
+            double samples = (i < sentence.samplesPerId.size() ? sentence.samplesPerId[i] : 0) * scale;
+
+            if (isSpecialId(id) || symbolIndex >= symbols.size()) {
+                // Padding belongs to the phoneme before it; BOS/EOS are silence
+                if (id == kPadId && !timeline.phonemes.empty() && symbolIndex > 0) {
+                    timeline.phonemes.back().duration += samples / sampleRate;
+                }
+                position += samples;
+                continue;
+            }
+
+            char32_t symbol = symbols[symbolIndex++];
+            Phoneme phoneme;
+            phoneme.symbol = QString::fromUcs4(&symbol, 1);
+            phoneme.id = id;
+            phoneme.startTime = position / sampleRate;
+            phoneme.duration = samples / sampleRate;
+            timeline.phonemes.push_back(phoneme);
+
+            position += samples;
+        }
+
+        position += silencePerSentence;
+    }
+
+    spdlog::debug("Timed {} phonemes over {} sentence(s), {:.3f}s",
+                  timeline.phonemes.size(), alignment.sentences.size(), timeline.totalDuration);
+    return timeline;
+}
+
+} // namespace Chatbot
@@ -0,0 +1,53 @@
+#ifndef CHATBOT_PHONEMETIMELINE_H
+#define CHATBOT_PHONEMETIMELINE_H
+
+#include <QString>
+#include <vector>
+
+namespace Chatbot {
+
+// Phoneme data structure with timing
+struct Phoneme {
+    QString symbol;      // Phoneme symbol (e.g., "h", "ə", "l")
+    int id;              // Phoneme ID from espeak
+    double startTime;    // Start time in seconds
+    double duration;     // Duration in seconds
+};
+
+// Timeline of phonemes for a spoken utterance
+struct PhonemeTimeline {
+    std::vector<Phoneme> phonemes;
+    double totalDuration = 0.0;  // Total audio duration in seconds
+    QString text;                // Original text
+};
+
+// What Piper reported for one sentence while synthesizing it
+struct AlignedSentence {
+    QString phonemes;              // One phoneme per code point
+    std::vector<int> phonemeIds;   // Model input, including pad/BOS/EOS IDs
+    std::vector<int> samplesPerId; // Audio samples per ID (approximated)
+    double audioSeconds = 0.0;     // Audio generated for the sentence (excl. sentence silence)
+};
+
+// Alignment of one utterance (Piper splits input lines into sentences)
+struct PhonemeAlignment {
+    std::vector<AlignedSentence> sentences;
+
+    bool isEmpty() const { return sentences.empty(); }
+};
+
+// Fill in samplesPerId by splitting the sentence's sample count across its
+// IDs with fixed weights per phoneme class (vowels longest, stress marks and
+// padding shortest). Piper reports no per-phoneme durations: only the
+// sentence boundaries are measured, the timings within are approximated.
+void approximateSamplesPerId(AlignedSentence& sentence, int sampleRate);
+
+// Build a timeline from Piper's phonemes for an utterance that produced
+// totalSamples of audio; the difference to the per-sentence audio is Piper's
+// sentence silence. Phoneme durations within a sentence come from samplesPerId.
+PhonemeTimeline buildPiperTimeline(const PhonemeAlignment& alignment, const QString& text,
+                                   qint64 totalSamples, int sampleRate);
+
+} // namespace Chatbot
+
+#endif // CHATBOT_PHONEMETIMELINE_H
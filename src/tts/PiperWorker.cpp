@@ -0,0 +1,488 @@
+#include "tts/PiperWorker.h"
+#include <QFile>
+#include <QTimer>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace Chatbot {
+
+namespace {
+constexpr int kMaxAttempts = 2;             // Attempts per request across restarts
+constexpr int kMaxConsecutiveFailures = 3;  // Restarts before giving up
+constexpr int kHealthCheckInterval = 1000;  // ms
+}
+
+PiperWorker::PiperWorker(QObject *parent)
+    : QObject(parent)
+    , m_process(std::make_unique<QProcess>())
+    , m_idleTimer(new QTimer(this))
+    , m_healthTimer(new QTimer(this))
+    , m_piperPath("./third_party/piper/piper")
+    , m_modelPath("./third_party/voices/en_US-lessac-medium.onnx")
+    , m_lengthScale(1.0)
+    , m_reportPhonemes(false)
+    , m_idleTimeout(5 * 60 * 1000)  // 5 minutes
+    , m_requestTimeout(30000)       // 30 seconds per utterance
+    , m_nextRequestId(1)
+    , m_consecutiveFailures(0)
+    , m_stopping(false)
+    , m_startPending(false)
+    , m_draining(false)
+{
+    connect(m_process.get(), &QProcess::started, this, &PiperWorker::onStarted);
+    connect(m_process.get(), &QProcess::readyReadStandardOutput,
+            this, &PiperWorker::onReadyReadStandardOutput);
+    connect(m_process.get(), &QProcess::readyReadStandardError,
+            this, &PiperWorker::onReadyReadStandardError);
+    connect(m_process.get(), &QProcess::finished, this, &PiperWorker::onProcessFinished);
+    connect(m_process.get(), &QProcess::errorOccurred, this, &PiperWorker::onProcessError);
+
+    m_idleTimer->setSingleShot(true);
+    connect(m_idleTimer, &QTimer::timeout, this, &PiperWorker::onIdleTimeout);
+
+    connect(m_healthTimer, &QTimer::timeout, this, &PiperWorker::onHealthCheck);
+    m_healthTimer->start(kHealthCheckInterval);
+}
+
+PiperWorker::~PiperWorker() {
+    m_healthTimer->stop();
+    m_idleTimer->stop();
+
+    // Nothing may run after this; the only place the GUI thread waits on Piper
+    m_process->disconnect(this);
+    if (m_process->state() != QProcess::NotRunning) {
+        m_process->kill();
+        m_process->waitForFinished(1000);
+    }
+}
+
+void PiperWorker::setPiperPath(const QString& path) {
+    if (m_piperPath == path) {
+        return;
+    }
+    m_piperPath = path;
+    if (isRunning()) {
+        relaunch("Piper path changed");
+    }
+}
+
+void PiperWorker::setModelPath(const QString& path) {
+    if (m_modelPath == path) {
+        return;
+    }
+    m_modelPath = path;
+    if (isRunning()) {
+        relaunch("Voice model changed");
+    }
+}
+
+void PiperWorker::setLengthScale(double lengthScale) {
+    if (m_lengthScale == lengthScale) {
+        return;
+    }
+    m_lengthScale = lengthScale;
+    if (isRunning()) {
+        relaunch("Length scale changed");
+    }
+}
+
+void PiperWorker::setReportPhonemes(bool enabled) {
+    if (m_reportPhonemes == enabled) {
+        return;
+    }
+    m_reportPhonemes = enabled;
+    if (isRunning()) {
+        relaunch("Phoneme reporting changed");
+    }
+}
+
+void PiperWorker::setIdleTimeout(int milliseconds) {
+    m_idleTimeout = milliseconds;
+    if (m_idleTimeout <= 0) {
+        m_idleTimer->stop();
+    }
+    spdlog::info("Piper worker idle timeout set to {} ms", milliseconds);
+}
+
+void PiperWorker::setRequestTimeout(int milliseconds) {
+    m_requestTimeout = milliseconds;
+}
+
+bool PiperWorker::start() {
+    if (m_stopping) {
+        m_startPending = true;  // Started once the old process has exited
+        return true;
+    }
+    if (m_process->state() != QProcess::NotRunning) {
+        return true;
+    }
+
+    QStringList args;
+    args << "--model" << m_modelPath;
+    args << "--json-input";
+    args << "--output_raw";
+
+    if (m_lengthScale != 1.0) {
+        args << "--length_scale" << QString::number(m_lengthScale);
+    }
+
+    // Piper only logs the phonemes it synthesizes at debug level
+    if (m_reportPhonemes) {
+        args << "--debug";
+    }
+
+    spdlog::info("Starting Piper worker: {}", m_piperPath.toStdString());
+    m_stopping = false;
+    m_stderrBuffer.clear();
+    m_process->setProgram(m_piperPath);
+    m_process->setArguments(args);
+    m_process->start();
+    return true;
+}
+
+void PiperWorker::shutdown() {
+    m_idleTimer->stop();
+    m_startPending = false;
+    stopProcess();
+    failAll();
+}
+
+bool PiperWorker::isHealthy() const {
+    if (!isRunning()) {
+        return false;
+    }
+    return !(m_inFlight && m_inFlightTimer.elapsed() > m_requestTimeout);
+}
+
+std::optional<int> PiperWorker::readSampleRate(const QString& modelPath) {
+    QFile configFile(modelPath + ".json");
+    if (!configFile.open(QIODevice::ReadOnly)) {
+        return std::nullopt;
+    }
+
+    try {
+        json config = json::parse(configFile.readAll().toStdString());
+        return config.at("audio").at("sample_rate").get<int>();
+    } catch (const json::exception& e) {
+        spdlog::warn("Failed to read voice config: {}", e.what());
+        return std::nullopt;
+    }
+}
+
+quint64 PiperWorker::synthesize(const QString& text) {
+    Request request;
+    request.id = m_nextRequestId++;
+    request.text = text;
+    m_queue.push_back(request);
+
+    m_idleTimer->stop();
+
+    if (m_process->state() == QProcess::NotRunning) {
+        start();  // Request is sent once the process has started
+    } else {
+        sendNextRequest();
+    }
+
+    return request.id;
+}
+
+void PiperWorker::cancel(quint64 requestId) {
+    if (m_inFlight && m_inFlight->id == requestId) {
+        m_inFlight->cancelled = true;
+        spdlog::debug("Utterance {} cancelled while synthesizing", requestId);
+        return;
+    }
+
+    auto it = std::find_if(m_queue.begin(), m_queue.end(),
+                           [requestId](const Request& request) { return request.id == requestId; });
+    if (it != m_queue.end()) {
+        m_queue.erase(it);
+        spdlog::debug("Utterance {} cancelled before synthesis", requestId);
+    }
+}
+
+void PiperWorker::onStarted() {
+    spdlog::info("Piper worker running (pid {})", m_process->processId());
+    sendNextRequest();
+
+    if (!m_inFlight && m_idleTimeout > 0) {
+        m_idleTimer->start(m_idleTimeout);
+    }
+}
+
+void PiperWorker::sendNextRequest() {
+    if (m_inFlight || m_queue.empty() || !isRunning()) {
+        return;
+    }
+
+    m_inFlight = m_queue.front();
+    m_queue.pop_front();
+    m_inFlight->attempts++;
+    m_inFlight->bytesReceived = 0;
+    m_inFlight->alignment = PhonemeAlignment{};
+
+    json line;
+    line["text"] = m_inFlight->text.toStdString();
+
+    spdlog::debug("Sending utterance {} to Piper worker", m_inFlight->id);
+    m_inFlightTimer.start();
+    m_process->write(QByteArray::fromStdString(line.dump() + "\n"));
+}
+
+void PiperWorker::onReadyReadStandardOutput() {
+    QByteArray pcm = m_process->readAllStandardOutput();
+    if (pcm.isEmpty()) {
+        return;
+    }
+
+    if (!m_inFlight) {
+        spdlog::warn("Discarding {} bytes of unexpected Piper output", pcm.size());
+        return;
+    }
+
+    m_inFlight->bytesReceived += pcm.size();
+    if (!m_inFlight->cancelled) {
+        emit audioChunk(m_inFlight->id, pcm);
+    }
+}
+
+void PiperWorker::onReadyReadStandardError() {
+    if (m_draining) {
+        return;  // Picked up by the loop below once draining is done
+    }
+
+    m_stderrBuffer += m_process->readAllStandardError();
+
+    int newline;
+    while ((newline = m_stderrBuffer.indexOf('\n')) != -1) {
+        QByteArray line = m_stderrBuffer.left(newline).trimmed();
+        m_stderrBuffer.remove(0, newline + 1);
+
+        if (!line.isEmpty()) {
+            handleLogLine(line);
+        }
+        m_stderrBuffer += m_process->readAllStandardError();
+    }
+}
+
+void PiperWorker::handleLogLine(const QByteArray& line) {
+    spdlog::trace("piper: {}", line.toStdString());
+
+    if (m_inFlight && m_reportPhonemes) {
+        parseAlignmentLine(line);
+    }
+
+    // Logged once per input line, after all of its audio was written
+    if (m_inFlight && line.contains("Real-time factor")) {
+        drainStandardOutput();
+        spdlog::debug("Piper worker finished utterance {} in {} ms ({} bytes)",
+                      m_inFlight->id, m_inFlightTimer.elapsed(), m_inFlight->bytesReceived);
+        completeInFlight(m_inFlight->bytesReceived > 0);
+    }
+}
+
+void PiperWorker::parseAlignmentLine(const QByteArray& line) {
+    // Piper logs these for every sentence of the input line, in this order
+    static const QByteArray phonemesMarker = "to ids: ";
+    static const QByteArray idsMarker = "phoneme id(s): ";
+    static const QByteArray audioMarker = "Synthesized ";
+
+    PhonemeAlignment& alignment = m_inFlight->alignment;
+    int pos;
+
+    if (line.contains("Converting") && (pos = line.indexOf(phonemesMarker)) != -1) {
+        AlignedSentence sentence;
+        sentence.phonemes = QString::fromUtf8(line.mid(pos + phonemesMarker.size()));
+        alignment.sentences.push_back(sentence);
+    } else if (line.contains("Converted") && (pos = line.indexOf(idsMarker)) != -1) {
+        if (alignment.sentences.empty()) {
+            return;
+        }
+        std::vector<int>& ids = alignment.sentences.back().phonemeIds;
+        ids.clear();
+        for (const QByteArray& id : line.mid(pos + idsMarker.size()).split(',')) {
+            bool ok = false;
+            int value = id.trimmed().toInt(&ok);
+            if (ok) {
+                ids.push_back(value);
+            }
+        }
+    } else if ((pos = line.indexOf(audioMarker)) != -1 && line.contains("second(s) of audio")) {
+        if (alignment.sentences.empty()) {
+            return;
+        }
+        QByteArray seconds = line.mid(pos + audioMarker.size());
+        seconds.truncate(seconds.indexOf(' '));
+        alignment.sentences.back().audioSeconds = seconds.toDouble();
+    }
+}
+
+void PiperWorker::drainStandardOutput() {
+    // stdout and stderr are separate pipes: audio written before the log line
+    // may not have been picked up by the event loop yet
+    m_draining = true;
+    while (m_process->waitForReadyRead(0)) {
+    }
+    m_draining = false;
+    onReadyReadStandardOutput();
+}
+
+void PiperWorker::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus) {
+    if (m_stopping) {
+        m_stopping = false;
+        spdlog::info("Piper worker stopped");
+
+        // A restart, relaunch or new request came in while it was exiting
+        if (m_startPending || !m_queue.empty()) {
+            m_startPending = false;
+            start();
+        }
+        return;
+    }
+
+    restart(QString("Piper exited unexpectedly (code %1, %2)")
+                .arg(exitCode)
+                .arg(exitStatus == QProcess::CrashExit ? "crashed" : "normal exit"));
+}
+
+void PiperWorker::onProcessError(QProcess::ProcessError error) {
+    if (error == QProcess::FailedToStart) {
+        spdlog::error("Failed to start Piper worker: {}", m_process->errorString().toStdString());
+        failAll();
+    }
+    // Crashes are handled in onProcessFinished
+}
+
+void PiperWorker::onIdleTimeout() {
+    if (m_inFlight || !m_queue.empty()) {
+        return;
+    }
+
+    spdlog::info("Piper worker idle for {} ms, shutting down", m_idleTimeout);
+    stopProcess();
+}
+
+void PiperWorker::onHealthCheck() {
+    if (m_inFlight && m_inFlightTimer.elapsed() > m_requestTimeout) {
+        restart(QString("Utterance %1 timed out after %2 ms").arg(m_inFlight->id).arg(m_requestTimeout));
+    }
+}
+
+void PiperWorker::completeInFlight(bool success) {
+    if (!m_inFlight) {
+        return;
+    }
+
+    quint64 id = m_inFlight->id;
+    bool cancelled = m_inFlight->cancelled;
+    PhonemeAlignment alignment = std::move(m_inFlight->alignment);
+    m_inFlight.reset();
+    if (success) {
+        m_consecutiveFailures = 0;
+    }
+
+    if (!cancelled) {
+        if (success && !alignment.isEmpty()) {
+            emit phonemesAligned(id, alignment);
+        }
+        emit synthesisFinished(id, success);
+    }
+
+    sendNextRequest();
+    if (!m_inFlight && m_queue.empty() && m_idleTimeout > 0) {
+        m_idleTimer->start(m_idleTimeout);
+    }
+}
+
+void PiperWorker::restart(const QString& reason) {
+    spdlog::warn("Restarting Piper worker: {}", reason.toStdString());
+
+    // Kill first, so nothing below hands the next request to this process
+    stopProcess();
+
+    // Retry the interrupted utterance on the new process, unless it already
+    // failed there before (it may be what brings Piper down)
+    if (m_inFlight) {
+        if (m_inFlight->cancelled) {
+            m_inFlight.reset();  // Nobody is waiting for it
+        } else if (m_inFlight->attempts < kMaxAttempts) {
+            m_queue.push_front(*m_inFlight);
+            m_inFlight.reset();
+        } else {
+            completeInFlight(false);
+        }
+    }
+
+    emit workerRestarted(reason);
+
+    if (++m_consecutiveFailures > kMaxConsecutiveFailures) {
+        spdlog::error("Piper worker failed {} times in a row, giving up until the next request",
+                      m_consecutiveFailures - 1);
+        m_consecutiveFailures = 0;
+        m_startPending = false;
+        failAll();
+        return;
+    }
+
+    // Back off a little on repeated failures
+    QTimer::singleShot(200 * (m_consecutiveFailures - 1), this, [this]() {
+        start();
+    });
+}
+
+void PiperWorker::relaunch(const QString& reason) {
+    spdlog::info("Relaunching Piper worker: {}", reason.toStdString());
+    stopProcess();
+
+    // Configuration changes are not failures; resend whatever was interrupted
+    if (m_inFlight) {
+        if (!m_inFlight->cancelled) {
+            m_inFlight->attempts--;
+            m_queue.push_front(*m_inFlight);
+        }
+        m_inFlight.reset();
+    }
+    start();
+}
+
+void PiperWorker::stopProcess() {
+    if (m_process->state() == QProcess::NotRunning) {
+        return;
+    }
+
+    // Does not wait: onProcessFinished() sees m_stopping once it has exited,
+    // and nothing is sent to the process in the meantime
+    m_stopping = true;
+    m_process->kill();
+    m_stderrBuffer.clear();
+}
+
+void PiperWorker::failAll() {
+    std::vector<quint64> failed;
+    if (m_inFlight) {
+        if (!m_inFlight->cancelled) {
+            failed.push_back(m_inFlight->id);
+        }
+        m_inFlight.reset();
+    }
+    for (const Request& request : m_queue) {
+        failed.push_back(request.id);
+    }
+    m_queue.clear();
+
+    for (quint64 id : failed) {
+        emit synthesisFinished(id, false);
+    }
+}
+
+bool PiperWorker::isRunning() const {
+    // A process that is being killed no longer counts
+    return m_process->state() == QProcess::Running && !m_stopping;
+}
+
+} // namespace Chatbot
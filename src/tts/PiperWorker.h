@@ -0,0 +1,148 @@
+#ifndef CHATBOT_PIPERWORKER_H
+#define CHATBOT_PIPERWORKER_H
+
+#include "tts/PhonemeTimeline.h"
+#include <QObject>
+#include <QString>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <deque>
+#include <memory>
+#include <optional>
+
+class QTimer;
+
+namespace Chatbot {
+
+/**
+ * PiperWorker keeps one Piper process running with the voice model loaded
+ * and feeds it utterances over stdin (one JSON line each, --json-input).
+ * Audio comes back on stdout as raw 16-bit mono PCM (--output_raw) and is
+ * forwarded chunk by chunk; Piper's per-utterance "Real-time factor" log
+ * line on stderr completes the request. Requests are processed one at a
+ * time, in order.
+ *
+ * With phoneme reporting enabled, Piper runs with --debug and the phonemes
+ * and model input IDs it logs for each sentence are collected into a
+ * PhonemeAlignment for the request, with the audio length of each
+ * sentence. Piper does not report how long each phoneme lasts, so
+ * durations within a sentence are approximated afterwards
+ * (approximateSamplesPerId).
+ *
+ * The process is restarted automatically if it crashes or a request hangs,
+ * and shut down after an idle timeout (restarted on the next request).
+ */
+class PiperWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PiperWorker(QObject *parent = nullptr);
+    ~PiperWorker() override;
+
+    // Delete copy constructor and assignment operator
+    PiperWorker(const PiperWorker&) = delete;
+    PiperWorker& operator=(const PiperWorker&) = delete;
+
+    // Configuration (changing any of these restarts a running worker)
+    void setPiperPath(const QString& path);
+    void setModelPath(const QString& path);
+    void setLengthScale(double lengthScale);
+    void setReportPhonemes(bool enabled);
+
+    // Shut the process down after this long without requests (0 = never)
+    void setIdleTimeout(int milliseconds);
+
+    // Restart the process if a single utterance takes longer than this
+    void setRequestTimeout(int milliseconds);
+
+    // Launch the process ahead of the first request so the model is loaded
+    bool start();
+
+    // Stop the process; queued requests are failed
+    void shutdown();
+
+    // True while the process is running and not stuck on a request
+    bool isHealthy() const;
+
+    // Sample rate of a voice, from the <model>.onnx.json config shipped with it
+    static std::optional<int> readSampleRate(const QString& modelPath);
+
+    // Queue an utterance for synthesis, returns its request ID
+    quint64 synthesize(const QString& text);
+
+    // Drop a request; no further signals are emitted for it. A queued request
+    // is removed, the one being synthesized runs to the end of the utterance
+    // with its audio discarded (Piper cannot stop mid-line without reloading
+    // the voice).
+    void cancel(quint64 requestId);
+
+signals:
+    // Raw PCM for the request being synthesized, as soon as Piper writes it
+    void audioChunk(quint64 requestId, const QByteArray& pcm);
+
+    // Phonemes Piper synthesized for a request, emitted just before synthesisFinished
+    void phonemesAligned(quint64 requestId, const PhonemeAlignment& alignment);
+
+    // Emitted once per request, in submission order, after its last audio chunk
+    void synthesisFinished(quint64 requestId, bool success);
+
+    // Emitted after the process had to be restarted
+    void workerRestarted(const QString& reason);
+
+private slots:
+    void onStarted();
+    void onReadyReadStandardOutput();
+    void onReadyReadStandardError();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onProcessError(QProcess::ProcessError error);
+    void onIdleTimeout();
+    void onHealthCheck();
+
+private:
+    struct Request {
+        quint64 id;
+        QString text;
+        int attempts = 0;
+        bool cancelled = false;
+        qint64 bytesReceived = 0;
+        PhonemeAlignment alignment;
+    };
+
+    void sendNextRequest();
+    void drainStandardOutput();
+    void handleLogLine(const QByteArray& line);
+    void parseAlignmentLine(const QByteArray& line);
+    void completeInFlight(bool success);
+    void restart(const QString& reason);   // After a failure
+    void relaunch(const QString& reason);  // After a configuration change
+    void stopProcess();
+    void failAll();
+    bool isRunning() const;
+
+private:
+    std::unique_ptr<QProcess> m_process;
+    QTimer* m_idleTimer;
+    QTimer* m_healthTimer;
+
+    QString m_piperPath;
+    QString m_modelPath;
+    double m_lengthScale;
+    bool m_reportPhonemes;
+    int m_idleTimeout;
+    int m_requestTimeout;
+
+    std::deque<Request> m_queue;
+    std::optional<Request> m_inFlight;
+    QElapsedTimer m_inFlightTimer;
+    QByteArray m_stderrBuffer;
+
+    quint64 m_nextRequestId;
+    int m_consecutiveFailures;
+    bool m_stopping;      // Process exit is expected (shutdown/idle/restart)
+    bool m_startPending;  // start() called while the old process was exiting
+    bool m_draining;      // Reading remaining audio before completing a request
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_PIPERWORKER_H
@@ -0,0 +1,110 @@
+#include "tts/SentenceSplitter.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+namespace Chatbot {
+
+namespace {
+
+bool isTerminator(QChar c) {
+    return c == '.' || c == '!' || c == '?' || c == QChar(0x2026);  // ellipsis
+}
+
+bool isClosing(QChar c) {
+    return c == '"' || c == '\'' || c == ')' || c == ']' || c == QChar(0x201D) || c == QChar(0x2019);
+}
+
+} // namespace
+
+SentenceSplitter::SentenceSplitter()
+    : m_scanPosition(0)
+    , m_minimumLength(20)
+    , m_receivedText(false)
+{
+}
+
+void SentenceSplitter::setMinimumLength(int length) {
+    m_minimumLength = length;
+}
+
+QStringList SentenceSplitter::feed(const QString& text) {
+    QStringList sentences;
+    if (text.isEmpty()) {
+        return sentences;
+    }
+
+    m_receivedText = true;
+    m_buffer += text;
+
+    int start = 0;
+    int end;
+    while ((end = findSentenceEnd(std::max(start, m_scanPosition))) != -1) {
+        QString sentence = m_buffer.mid(start, end - start).trimmed();
+        m_scanPosition = end;
+
+        if (sentence.length() < m_minimumLength) {
+            continue;  // Keep accumulating into the next sentence
+        }
+
+        sentences.append(sentence);
+        start = end;
+    }
+
+    if (start > 0) {
+        m_buffer.remove(0, start);
+        m_scanPosition -= start;
+    }
+
+    for (const QString& sentence : sentences) {
+        spdlog::debug("Sentence ready for synthesis: {}", sentence.toStdString());
+    }
+    return sentences;
+}
+
+QString SentenceSplitter::flush() {
+    QString rest = m_buffer.trimmed();
+    reset();
+    return rest;
+}
+
+void SentenceSplitter::reset() {
+    m_buffer.clear();
+    m_scanPosition = 0;
+    m_receivedText = false;
+}
+
+int SentenceSplitter::findSentenceEnd(int from) const {
+    const int length = m_buffer.length();
+
+    for (int i = from; i < length; ++i) {
+        QChar c = m_buffer[i];
+
+        if (c == '\n') {
+            return i + 1;
+        }
+
+        if (!isTerminator(c)) {
+            continue;
+        }
+
+        // Include runs like "?!" or "..." and closing quotes/brackets
+        int j = i + 1;
+        while (j < length && (isTerminator(m_buffer[j]) || isClosing(m_buffer[j]))) {
+            ++j;
+        }
+
+        // Need the following character to tell "3.14" or "e.g." from an
+        // end of sentence; wait for more text if the buffer ends here
+        if (j >= length) {
+            return -1;
+        }
+        if (m_buffer[j].isSpace()) {
+            return j;
+        }
+        i = j - 1;
+    }
+
+    return -1;
+}
+
+} // namespace Chatbot
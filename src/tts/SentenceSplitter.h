@@ -0,0 +1,48 @@
+#ifndef CHATBOT_SENTENCESPLITTER_H
+#define CHATBOT_SENTENCESPLITTER_H
+
+#include <QString>
+#include <QStringList>
+
+namespace Chatbot {
+
+/**
+ * SentenceSplitter cuts incrementally received text into sentences so each
+ * one can be synthesized as soon as it is complete.
+ */
+class SentenceSplitter {
+public:
+    SentenceSplitter();
+    ~SentenceSplitter() = default;
+
+    // Sentences shorter than this are merged with the next one
+    // (avoids tiny utterances for "Dr." or "1." list markers)
+    void setMinimumLength(int length);
+
+    // Append text, returning every sentence it completed
+    QStringList feed(const QString& text);
+
+    // Return the remaining text (possibly empty) and reset
+    QString flush();
+
+    // Discard buffered text
+    void reset();
+
+    // True if any text was fed since the last reset/flush
+    bool hasReceivedText() const { return m_receivedText; }
+
+private:
+    // Index just past the sentence ending at or after 'from', or -1 if the
+    // buffer does not yet contain a complete sentence
+    int findSentenceEnd(int from) const;
+
+private:
+    QString m_buffer;
+    int m_scanPosition;  // Buffer index up to which no boundary was found
+    int m_minimumLength;
+    bool m_receivedText;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_SENTENCESPLITTER_H
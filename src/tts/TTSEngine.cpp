@@ -1,176 +1,567 @@
 #include "tts/TTSEngine.h"
 #include "tts/PhonemeExtractor.h"
-#include <QProcess>
-#include <QFile>
-#include <QFileInfo>
-#include <QDir>
-#include <QUrl>
+#include "tts/PiperWorker.h"
+#include "tts/TtsCache.h"
+#include <QTimer>
+#include <QThreadPool>
 #include <QAudioFormat>
-#include <QMediaMetaData>
+#include <QMediaDevices>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <utility>
 
 namespace Chatbot {
 
 TTSEngine::TTSEngine(QObject *parent)
     : QObject(parent)
-    , m_mediaPlayer(std::make_unique<QMediaPlayer>(this))
-    , m_audioOutput(std::make_unique<QAudioOutput>(this))
+    , m_audioDevice(nullptr)
+    , m_feedTimer(new QTimer(this))
+    , m_streamBytes(0)
+    , m_sampleRate(22050)
     , m_phonemeExtractor(std::make_unique<PhonemeExtractor>())
+    , m_piperWorker(std::make_unique<PiperWorker>())
+    , m_audioCache(std::make_shared<TtsCache>())
     , m_piperPath("./third_party/piper/piper")
     , m_modelPath("./third_party/voices/en_US-lessac-medium.onnx")
     , m_espeakDataPath("./third_party/piper/espeak-ng-data")
     , m_voiceSpeed(1.0)
+    , m_timingMode(PhonemeTimingMode::Alignment)
+    , m_visemeMapper(nullptr)
+    , m_currentVisemeIndex(VisemeMapper::kSilenceIndex)
     , m_currentPhonemeIndex(-1)
+    , m_furthestPhonemeIndex(-1)
     , m_isPlaying(false)
+    , m_synthesisInFlight(false)
+    , m_speechActive(false)
+    , m_generation(0)
+    , m_inFlightStreamOffset(0)
+    , m_inFlightRequestId(0)
+    , m_inFlightGeneration(0)
+    , m_warmupRequestId(0)
 {
-    // Set up media player
-    m_mediaPlayer->setAudioOutput(m_audioOutput.get());
-    m_audioOutput->setVolume(1.0);
-
-    // Connect signals
-    connect(m_mediaPlayer.get(), &QMediaPlayer::mediaStatusChanged,
-            this, &TTSEngine::onMediaStatusChanged);
-    connect(m_mediaPlayer.get(), &QMediaPlayer::playbackStateChanged,
-            this, &TTSEngine::onPlaybackStateChanged);
-    connect(m_mediaPlayer.get(), &QMediaPlayer::positionChanged,
-            this, &TTSEngine::onPositionChanged);
+    // Feed the audio sink from the ring buffer; phonemes are looked up per
+    // frame in updateLipSync()
+    connect(m_feedTimer, &QTimer::timeout, this, &TTSEngine::feedAudioSink);
 
     // Configure phoneme extractor
     m_phonemeExtractor->setPhonemizePath("./third_party/piper/piper_phonemize");
     m_phonemeExtractor->setEspeakDataPath(m_espeakDataPath);
 
+    // Keep a Piper process warm so utterances don't pay for loading the voice model
+    loadVoiceConfig();
+    m_piperWorker->setPiperPath(m_piperPath);
+    m_piperWorker->setModelPath(m_modelPath);
+    m_piperWorker->setReportPhonemes(true);
+    connect(m_piperWorker.get(), &PiperWorker::audioChunk,
+            this, &TTSEngine::onAudioChunk);
+    connect(m_piperWorker.get(), &PiperWorker::phonemesAligned,
+            this, &TTSEngine::onPhonemesAligned);
+    connect(m_piperWorker.get(), &PiperWorker::synthesisFinished,
+            this, &TTSEngine::onAudioGenerated);
+    m_piperWorker->start();
+
     spdlog::info("TTSEngine initialized");
 }
 
 TTSEngine::~TTSEngine() {
     stop();
+    // The worker thread uses this engine's configuration until it returns
+    m_synthesisFuture.waitForFinished();
     spdlog::info("TTSEngine destroyed");
 }
 
 void TTSEngine::setPiperPath(const QString& path) {
     m_piperPath = path;
+    m_piperWorker->setPiperPath(path);
     spdlog::info("Piper path set to: {}", path.toStdString());
 }
 
 void TTSEngine::setModelPath(const QString& path) {
     m_modelPath = path;
+    loadVoiceConfig();
+    m_piperWorker->setModelPath(path);
     spdlog::info("Model path set to: {}", path.toStdString());
 }
 
 void TTSEngine::setVoiceSpeed(double speed) {
     m_voiceSpeed = speed;
+    m_piperWorker->setLengthScale(1.0 / speed);
     spdlog::info("Voice speed set to: {}", speed);
 }
 
+void TTSEngine::setWorkerIdleTimeout(int milliseconds) {
+    m_piperWorker->setIdleTimeout(milliseconds);
+}
+
+void TTSEngine::setPhonemeTimingMode(PhonemeTimingMode mode) {
+    m_timingMode = mode;
+    m_piperWorker->setReportPhonemes(mode == PhonemeTimingMode::Alignment);
+    spdlog::info("Phoneme timing mode set to: {}",
+                 mode == PhonemeTimingMode::Alignment ? "alignment" : "phonemize");
+}
+
+void TTSEngine::setAudioCache(std::shared_ptr<TtsCache> cache) {
+    m_audioCache = std::move(cache);
+    spdlog::info("TTS audio cache {}", m_audioCache ? "enabled" : "disabled");
+}
+
+void TTSEngine::prewarm(const QStringList& texts) {
+    if (!m_audioCache || m_timingMode != PhonemeTimingMode::Alignment) {
+        spdlog::info("Skipping TTS warm-up (needs the audio cache and alignment timing)");
+        return;
+    }
+
+    for (const QString& text : texts) {
+        if (!text.trimmed().isEmpty()) {
+            m_warmupTexts.push_back(text);
+        }
+    }
+    spdlog::info("TTS warm-up: {} phrases queued", m_warmupTexts.size());
+    startNextWarmup();
+}
+
+void TTSEngine::setVisemeMapper(const VisemeMapper* mapper) {
+    // Indices from a previous mapper are meaningless for the new one
+    m_visemeTrack.clear();
+    m_currentVisemeIndex = VisemeMapper::kSilenceIndex;
+    m_visemeMapper = mapper;
+}
+
 void TTSEngine::synthesize(const QString& text) {
-    if (m_isPlaying) {
-        spdlog::warn("Already playing audio, stopping current playback");
+    if (m_speechActive) {
+        spdlog::warn("Already speaking, stopping current playback");
         stop();
     }
 
+    enqueue(text);
+}
+
+void TTSEngine::enqueue(const QString& text) {
     if (text.trimmed().isEmpty()) {
         spdlog::warn("Empty text for synthesis");
         emit errorOccurred("Text cannot be empty");
         return;
     }
 
-    spdlog::info("Starting synthesis for: {}", text.toStdString());
-    emit synthesisStarted();
-
-    // Generate unique filename for this utterance
-    QString tempDir = QDir::tempPath();
-    QString audioFile = tempDir + "/chatbot_tts_" + QString::number(QDateTime::currentMSecsSinceEpoch()) + ".wav";
-
-    // Generate audio file
-    if (!generateAudio(text, audioFile)) {
-        emit errorOccurred("Failed to generate audio");
-        return;
+    spdlog::info("Queueing synthesis for: {}", text.toStdString());
+    m_pendingTexts.push_back(text);
+
+    // Speech preempts warm-up: the phrase is dropped from Piper's queue (or
+    // its audio discarded, if Piper already started it) and tried again
+    // once speech is over
+    if (m_warmupRequestId != 0) {
+        m_piperWorker->cancel(m_warmupRequestId);
+        m_warmupRequestId = 0;
+        m_warmupTexts.push_front(m_warmupText);
+        m_warmupPcm.clear();
+        spdlog::debug("TTS warm-up deferred for speech: {}", m_warmupText.toStdString());
     }
 
-    // Get audio duration (read WAV header)
-    QFile wavFile(audioFile);
-    double audioDuration = 0.0;
-    if (wavFile.open(QIODevice::ReadOnly)) {
-        // WAV file size to duration estimation (assuming 22050 Hz, 16-bit, mono)
-        qint64 fileSize = wavFile.size();
-        qint64 dataSize = fileSize - 44;  // Subtract header size
-        audioDuration = static_cast<double>(dataSize) / (22050.0 * 2.0);  // 2 bytes per sample
-        wavFile.close();
-        spdlog::debug("Audio duration: {} seconds", audioDuration);
+    if (!m_speechActive) {
+        m_speechActive = true;
+        emit synthesisStarted();
     }
 
-    // Extract phoneme timeline
-    m_currentTimeline = extractPhonemeTimeline(text, audioDuration);
-    m_currentPhonemeIndex = 0;
-
-    // Set media source and play
-    m_mediaPlayer->setSource(QUrl::fromLocalFile(audioFile));
-    m_mediaPlayer->play();
+    startNextSynthesis();
 }
 
 void TTSEngine::stop() {
+    ++m_generation;
+    m_pendingTexts.clear();
+    m_speechActive = false;
+
+    // Piper has to finish the sentence it is on, but nothing waits for it:
+    // the next speech run is queued right behind instead of after its result
+    if (m_synthesisInFlight && m_inFlightRequestId != 0) {
+        m_piperWorker->cancel(m_inFlightRequestId);
+        m_inFlightRequestId = 0;
+        m_synthesisInFlight = false;
+    }
+
     if (m_isPlaying) {
-        m_mediaPlayer->stop();
-        m_isPlaying = false;
-        m_currentPhonemeIndex = -1;
+        stopPlayback();
         spdlog::info("Playback stopped");
     }
+
+    // Deferred: synthesize() queues its text right after stopping
+    QTimer::singleShot(0, this, &TTSEngine::startNextWarmup);
 }
 
 bool TTSEngine::isPlaying() const {
     return m_isPlaying;
 }
 
-bool TTSEngine::generateAudio(const QString& text, const QString& outputPath) {
-    spdlog::debug("Generating audio to: {}", outputPath.toStdString());
-
-    // Create QProcess to run Piper
-    QProcess process;
-    process.setProgram(m_piperPath);
+void TTSEngine::startNextSynthesis() {
+    if (m_synthesisInFlight || m_pendingTexts.empty()) {
+        return;
+    }
 
-    QStringList args;
-    args << "--model" << m_modelPath;
-    args << "--output_file" << outputPath;
+    m_inFlightText = m_pendingTexts.front();
+    m_pendingTexts.pop_front();
+    m_synthesisInFlight = true;
+    m_inFlightGeneration = m_generation;
+    m_inFlightStreamOffset = m_streamBytes;
+    m_inFlightAlignment = PhonemeAlignment{};
+    m_inFlightPcm.clear();
 
-    if (m_voiceSpeed != 1.0) {
-        args << "--length_scale" << QString::number(1.0 / m_voiceSpeed);
+    if (playFromCache(m_inFlightText)) {
+        return;
     }
 
-    process.setArguments(args);
+    // Piper works on this while the current utterance keeps playing
+    m_inFlightRequestId = m_piperWorker->synthesize(m_inFlightText);
+}
 
-    // Start process
-    process.start();
-    if (!process.waitForStarted()) {
-        spdlog::error("Failed to start Piper: {}", process.errorString().toStdString());
+bool TTSEngine::playFromCache(const QString& text) {
+    if (!m_audioCache) {
         return false;
     }
 
-    // Write text to stdin
-    process.write(text.toUtf8());
-    process.closeWriteChannel();
-
-    // Wait for completion (max 30 seconds)
-    if (!process.waitForFinished(30000)) {
-        spdlog::error("Piper timeout");
-        process.kill();
+    std::optional<CachedUtterance> cached = m_audioCache->lookup(cacheKey(text));
+    if (!cached || cached->sampleRate != m_sampleRate) {
         return false;
     }
 
-    // Check exit code
-    if (process.exitCode() != 0) {
-        QString errorOutput = process.readAllStandardError();
-        spdlog::error("Piper failed: {}", errorOutput.toStdString());
-        return false;
+    // Same path as streamed Piper audio, only all at once; copied straight
+    // from the cache file's mapping (released when cached goes out of scope)
+    m_audioBuffer.write(cached->pcm.constData(), cached->pcm.size());
+    m_streamBytes += cached->pcm.size();
+    startPlayback();
+    feedAudioSink();
+
+    SynthesizedUtterance utterance;
+    utterance.success = true;
+    utterance.streamOffset = bytesToSeconds(m_inFlightStreamOffset);
+    utterance.timeline = std::move(cached->timeline);
+    onSynthesisFinished(utterance, m_inFlightGeneration);
+    return true;
+}
+
+void TTSEngine::storeInCache(const QString& text, const QByteArray& pcm, const PhonemeTimeline& timeline) {
+    if (!m_audioCache || pcm.isEmpty() || timeline.phonemes.empty()) {
+        return;
     }
 
-    // Verify output file exists
-    if (!QFile::exists(outputPath)) {
-        spdlog::error("Audio file not created: {}", outputPath.toStdString());
-        return false;
+    CachedUtterance utterance;
+    utterance.pcm = pcm;
+    utterance.sampleRate = m_sampleRate;
+    utterance.timeline = timeline;
+
+    // Writing the file stays off the GUI thread; the task keeps the cache alive
+    QThreadPool::globalInstance()->start([cache = m_audioCache, key = cacheKey(text), utterance]() {
+        cache->insert(key, utterance);
+    });
+}
+
+void TTSEngine::startNextWarmup() {
+    // Speech always comes first; warm-up resumes once it is over
+    if (m_warmupRequestId != 0 || m_speechActive || !m_audioCache) {
+        return;
     }
 
-    spdlog::debug("Audio generated successfully");
-    return true;
+    while (!m_warmupTexts.empty()) {
+        QString text = m_warmupTexts.front();
+        m_warmupTexts.pop_front();
+        if (m_audioCache->contains(cacheKey(text))) {
+            continue;  // Cached by an earlier run
+        }
+
+        m_warmupText = text;
+        m_warmupPcm.clear();
+        m_warmupAlignment = PhonemeAlignment{};
+        m_warmupRequestId = m_piperWorker->synthesize(text);
+        return;
+    }
+}
+
+void TTSEngine::finishWarmup(bool success) {
+    m_warmupRequestId = 0;
+
+    if (!success || m_warmupAlignment.isEmpty()) {
+        spdlog::warn("TTS warm-up failed for: {}", m_warmupText.toStdString());
+    } else {
+        PhonemeTimeline timeline = buildPiperTimeline(m_warmupAlignment, m_warmupText,
+                                                      m_warmupPcm.size() / 2, m_sampleRate);
+        storeInCache(m_warmupText, m_warmupPcm, timeline);
+        spdlog::debug("TTS warm-up cached: {}", m_warmupText.toStdString());
+    }
+
+    m_warmupPcm.clear();
+    startNextWarmup();
+}
+
+QString TTSEngine::cacheKey(const QString& text) const {
+    return TtsCache::makeKey(text, m_modelPath, 1.0 / m_voiceSpeed);
+}
+
+void TTSEngine::onAudioChunk(quint64 requestId, const QByteArray& pcm) {
+    if (requestId != 0 && requestId == m_warmupRequestId) {
+        m_warmupPcm.append(pcm);
+        return;
+    }
+    if (requestId != m_inFlightRequestId || m_inFlightGeneration != m_generation) {
+        return;  // Stopped since this utterance was requested
+    }
+
+    m_audioBuffer.write(pcm.constData(), pcm.size());
+    m_streamBytes += pcm.size();
+    if (m_audioCache) {
+        m_inFlightPcm.append(pcm);
+    }
+
+    // Start speaking on the first chunk instead of waiting for the utterance
+    startPlayback();
+    feedAudioSink();
+}
+
+void TTSEngine::onPhonemesAligned(quint64 requestId, const PhonemeAlignment& alignment) {
+    bool warmup = requestId != 0 && requestId == m_warmupRequestId;
+    if (requestId != m_inFlightRequestId && !warmup) {
+        return;
+    }
+
+    PhonemeAlignment& target = warmup ? m_warmupAlignment : m_inFlightAlignment;
+    target = alignment;
+    for (AlignedSentence& sentence : target.sentences) {
+        approximateSamplesPerId(sentence, m_sampleRate);
+    }
+}
+
+void TTSEngine::onAudioGenerated(quint64 requestId, bool success) {
+    if (requestId != 0 && requestId == m_warmupRequestId) {
+        finishWarmup(success);
+        return;
+    }
+    if (requestId != m_inFlightRequestId) {
+        return;
+    }
+    m_inFlightRequestId = 0;  // Piper is done with it
+
+    quint64 generation = m_inFlightGeneration;
+    if (!success) {
+        spdlog::error("Piper failed to synthesize: {}", m_inFlightText.toStdString());
+        onSynthesisFinished(SynthesizedUtterance{}, generation);
+        return;
+    }
+
+    // The exact duration is known from the PCM received for this utterance
+    double streamOffset = bytesToSeconds(m_inFlightStreamOffset);
+    double audioDuration = bytesToSeconds(m_streamBytes - m_inFlightStreamOffset);
+    spdlog::debug("Audio duration: {} seconds", audioDuration);
+
+    // Piper already told us what it said and for how long; no need to phonemize again
+    if (m_timingMode == PhonemeTimingMode::Alignment && !m_inFlightAlignment.isEmpty()) {
+        SynthesizedUtterance utterance;
+        utterance.success = true;
+        utterance.streamOffset = streamOffset;
+        utterance.timeline = buildPiperTimeline(m_inFlightAlignment, m_inFlightText,
+                                                (m_streamBytes - m_inFlightStreamOffset) / 2,
+                                                m_sampleRate);
+        storeInCache(m_inFlightText, m_inFlightPcm, utterance.timeline);
+        onSynthesisFinished(utterance, generation);
+        return;
+    }
+
+    // Timeline extraction runs piper_phonemize; keep it off the GUI thread
+    QString text = m_inFlightText;
+    QByteArray pcm = std::exchange(m_inFlightPcm, QByteArray());
+    m_synthesisFuture = QtConcurrent::run([this, text, audioDuration, streamOffset]() {
+        SynthesizedUtterance utterance;
+        utterance.success = true;
+        utterance.streamOffset = streamOffset;
+        utterance.timeline = extractPhonemeTimeline(text, audioDuration);
+        return utterance;
+    });
+
+    QFutureWatcher<SynthesizedUtterance>* watcher = new QFutureWatcher<SynthesizedUtterance>(this);
+    connect(watcher, &QFutureWatcher<SynthesizedUtterance>::finished, this, [this, watcher, generation, text, pcm]() {
+        storeInCache(text, pcm, watcher->result().timeline);
+        onSynthesisFinished(watcher->result(), generation);
+        watcher->deleteLater();
+    });
+    watcher->setFuture(m_synthesisFuture);
+}
+
+void TTSEngine::onSynthesisFinished(const SynthesizedUtterance& utterance, quint64 generation) {
+    m_synthesisInFlight = false;
+
+    if (generation != m_generation) {
+        // Stopped while this utterance was being synthesized
+        spdlog::debug("Discarding stale utterance");
+        startNextSynthesis();
+        return;
+    }
+
+    if (!utterance.success) {
+        emit errorOccurred("Failed to generate audio");
+    } else {
+        // Utterances complete in stream order, so the stream timeline stays sorted
+        for (Phoneme phoneme : utterance.timeline.phonemes) {
+            phoneme.startTime += utterance.streamOffset;
+            m_currentTimeline.phonemes.push_back(phoneme);
+        }
+        m_timelineCursor.append(utterance.timeline.phonemes, utterance.streamOffset);
+        if (m_visemeMapper) {
+            m_visemeTrack.append(utterance.timeline, utterance.streamOffset, *m_visemeMapper);
+        }
+        m_lipSyncStats.phonemes = static_cast<int>(m_currentTimeline.phonemes.size());
+        m_currentTimeline.totalDuration = utterance.streamOffset + utterance.timeline.totalDuration;
+        emit playbackStarted(utterance.timeline);
+    }
+
+    if (!m_isPlaying && m_pendingTexts.empty()) {
+        finishSpeech();
+        return;
+    }
+
+    startNextSynthesis();
+}
+
+void TTSEngine::finishSpeech() {
+    m_speechActive = false;
+    m_currentPhonemeIndex = -1;
+    emit playbackFinished();
+    spdlog::info("Playback finished");
+
+    startNextWarmup();
+}
+
+void TTSEngine::startPlayback() {
+    if (m_audioDevice) {
+        return;
+    }
+
+    QAudioFormat format;
+    format.setSampleRate(m_sampleRate);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    if (!m_audioSink || m_audioSink->format() != format) {
+        m_audioSink = std::make_unique<QAudioSink>(QMediaDevices::defaultAudioOutput(), format);
+        m_audioSink->setVolume(1.0);
+    }
+
+    // Push mode: feedAudioSink() writes as much as the sink can take
+    m_audioDevice = m_audioSink->start();
+    if (!m_audioDevice) {
+        spdlog::error("Failed to start audio output (error {})", static_cast<int>(m_audioSink->error()));
+        emit errorOccurred("Failed to start audio output");
+        return;
+    }
+
+    m_isPlaying = true;
+    m_audioClock.start();
+    m_lipSyncStats = LipSyncStats{};
+    m_frameTimer.invalidate();
+    m_feedTimer->start(10);
+    spdlog::debug("Audio playback started ({} Hz)", m_sampleRate);
+}
+
+void TTSEngine::stopPlayback() {
+    if (m_isPlaying) {
+        logLipSyncStats();
+    }
+
+    m_feedTimer->stop();
+    m_audioClock.stop();
+    if (m_audioSink) {
+        m_audioSink->stop();
+    }
+    m_audioDevice = nullptr;
+
+    m_audioBuffer.clear();
+    m_streamBytes = 0;
+    m_currentTimeline.phonemes.clear();
+    m_currentTimeline.totalDuration = 0.0;
+    m_timelineCursor.clear();
+    m_visemeTrack.clear();
+    m_currentVisemeIndex = VisemeMapper::kSilenceIndex;
+    m_currentPhonemeIndex = -1;
+    m_furthestPhonemeIndex = -1;
+    m_isPlaying = false;
+}
+
+void TTSEngine::feedAudioSink() {
+    if (!m_audioDevice) {
+        return;
+    }
+
+    qint64 bytesFree = m_audioSink->bytesFree();
+    if (bytesFree > 0 && !m_audioBuffer.isEmpty()) {
+        if (m_feedChunk.size() < bytesFree) {
+            m_feedChunk.resize(bytesFree);
+        }
+        qint64 count = m_audioBuffer.peek(m_feedChunk.data(), bytesFree);
+        qint64 written = m_audioDevice->write(m_feedChunk.constData(), count);
+        m_audioBuffer.discard(std::max<qint64>(written, 0));
+    }
+
+    // The sink's position only advances once per audio period; the clock
+    // interpolates from here for the per-frame lip-sync lookups
+    double playedTime = m_audioSink->processedUSecs() / 1000000.0;  // Convert us to seconds
+    m_audioClock.sync(playedTime, bytesToSeconds(m_streamBytes - m_audioBuffer.available()));
+
+    // Everything queued has been synthesized and played out
+    bool moreAudioExpected = m_synthesisInFlight || !m_pendingTexts.empty();
+    if (!moreAudioExpected && m_audioBuffer.isEmpty() && m_audioSink->state() == QAudio::IdleState) {
+        stopPlayback();
+        finishSpeech();
+    }
+}
+
+void TTSEngine::updateLipSync() {
+    if (!m_isPlaying) {
+        return;
+    }
+
+    if (m_frameTimer.isValid()) {
+        double interval = m_frameTimer.nsecsElapsed() / 1e9;
+        m_lipSyncStats.maxFrameInterval = std::max(m_lipSyncStats.maxFrameInterval, interval);
+    }
+    m_frameTimer.start();
+    m_lipSyncStats.frames++;
+
+    double currentTime = m_audioClock.now();
+    updateCurrentPhoneme(currentTime);
+
+    if (m_visemeMapper) {
+        int viseme = m_visemeTrack.sample(currentTime);
+        if (viseme != m_currentVisemeIndex) {
+            m_currentVisemeIndex = viseme;
+            emit visemeChanged(m_visemeMapper->visemeAt(viseme));
+        }
+    }
+}
+
+void TTSEngine::logLipSyncStats() const {
+    if (m_lipSyncStats.frames == 0) {
+        return;
+    }
+
+    spdlog::info("Lip-sync: {}/{} phonemes shown, {} skipped (hit rate {:.1f}%), "
+                 "{} frames, max frame interval {:.1f} ms",
+                 m_lipSyncStats.shown, m_lipSyncStats.phonemes, m_lipSyncStats.skipped,
+                 m_lipSyncStats.hitRate() * 100.0, m_lipSyncStats.frames,
+                 m_lipSyncStats.maxFrameInterval * 1000.0);
+}
+
+void TTSEngine::loadVoiceConfig() {
+    // Piper voices ship a <model>.onnx.json config describing the audio they produce
+    std::optional<int> sampleRate = PiperWorker::readSampleRate(m_modelPath);
+    if (!sampleRate) {
+        spdlog::warn("Voice config not readable for {}, assuming {} Hz",
+                     m_modelPath.toStdString(), m_sampleRate);
+        return;
+    }
+
+    m_sampleRate = *sampleRate;
+    spdlog::info("Voice sample rate: {} Hz", m_sampleRate);
+}
+
+double TTSEngine::bytesToSeconds(qint64 bytes) const {
+    return static_cast<double>(bytes) / (m_sampleRate * 2.0);  // 2 bytes per sample
 }
 
 PhonemeTimeline TTSEngine::extractPhonemeTimeline(const QString& text, double audioDuration) {
@@ -209,54 +600,21 @@ PhonemeTimeline TTSEngine::extractPhonemeTimeline(const QString& text, double au
 }
 
 void TTSEngine::updateCurrentPhoneme(double currentTime) {
-    if (m_currentTimeline.phonemes.empty()) {
+    // Constant time per tick: the cursor continues from the last phoneme
+    int index = m_timelineCursor.seek(currentTime);
+    if (index < 0 || index == m_currentPhonemeIndex) {
         return;
     }
 
-    // Find the phoneme that should be active at currentTime
-    for (size_t i = 0; i < m_currentTimeline.phonemes.size(); ++i) {
-        const auto& phoneme = m_currentTimeline.phonemes[i];
-        double endTime = phoneme.startTime + phoneme.duration;
-
-        if (currentTime >= phoneme.startTime && currentTime < endTime) {
-            if (static_cast<int>(i) != m_currentPhonemeIndex) {
-                m_currentPhonemeIndex = static_cast<int>(i);
-                emit currentPhoneme(phoneme, m_currentPhonemeIndex);
-                spdlog::debug("Current phoneme: {} at {:.3f}s", phoneme.symbol.toStdString(), currentTime);
-            }
-            break;
-        }
-    }
-}
-
-void TTSEngine::onMediaStatusChanged(QMediaPlayer::MediaStatus status) {
-    spdlog::debug("Media status changed: {}", static_cast<int>(status));
-
-    if (status == QMediaPlayer::LoadedMedia) {
-        // Media loaded, emit playback started with timeline
-        emit playbackStarted(m_currentTimeline);
-    } else if (status == QMediaPlayer::EndOfMedia) {
-        m_isPlaying = false;
-        m_currentPhonemeIndex = -1;
-        emit playbackFinished();
-        spdlog::info("Playback finished");
-    }
-}
-
-void TTSEngine::onPlaybackStateChanged(QMediaPlayer::PlaybackState state) {
-    spdlog::debug("Playback state changed: {}", static_cast<int>(state));
-
-    if (state == QMediaPlayer::PlayingState) {
-        m_isPlaying = true;
-    } else if (state == QMediaPlayer::StoppedState) {
-        m_isPlaying = false;
+    // Phonemes between the last one shown and this one were never on screen
+    if (index > m_furthestPhonemeIndex) {
+        m_lipSyncStats.skipped += index - m_furthestPhonemeIndex - 1;
+        m_furthestPhonemeIndex = index;
     }
-}
+    m_lipSyncStats.shown++;
 
-void TTSEngine::onPositionChanged(qint64 position) {
-    // Update current phoneme based on playback position
-    double currentTime = position / 1000.0;  // Convert ms to seconds
-    updateCurrentPhoneme(currentTime);
+    m_currentPhonemeIndex = index;
+    emit currentPhoneme(m_currentTimeline.phonemes[static_cast<size_t>(index)], m_currentPhonemeIndex);
 }
 
 } // namespace Chatbot
@@ -1,31 +1,56 @@
 #ifndef CHATBOT_TTSENGINE_H
 #define CHATBOT_TTSENGINE_H
 
+#include "avatar/VisemeTrack.h"
+#include "tts/AudioClock.h"
+#include "tts/AudioRingBuffer.h"
+#include "tts/PhonemeTimeline.h"
+#include "tts/TimelineCursor.h"
 #include <QObject>
 #include <QString>
-#include <QMediaPlayer>
-#include <QAudioOutput>
+#include <QStringList>
+#include <QAudioSink>
+#include <QFuture>
+#include <QElapsedTimer>
+#include <deque>
 #include <memory>
 #include <vector>
 
+class QTimer;
+class QIODevice;
+
 namespace Chatbot {
 
 // Forward declarations
 class PhonemeExtractor;
+class PiperWorker;
+class TtsCache;
+
+// How phoneme timings are obtained for an utterance
+enum class PhonemeTimingMode {
+    Alignment,  // From the phonemes and sentence lengths Piper reports while synthesizing;
+                // durations within a sentence are approximated (falls back to Phonemize)
+    Phonemize   // Run piper_phonemize and spread phonemes evenly over the audio
+};
 
-// Phoneme data structure with timing
-struct Phoneme {
-    QString symbol;      // Phoneme symbol (e.g., "h", "ə", "l")
-    int id;              // Phoneme ID from espeak
-    double startTime;    // Start time in seconds
-    double duration;     // Duration in seconds
+// Timeline produced for one queued sentence, whose audio was streamed for playback
+struct SynthesizedUtterance {
+    bool success = false;
+    double streamOffset = 0.0;  // Where the utterance starts in the playback stream (seconds)
+    PhonemeTimeline timeline;   // Times relative to the utterance start
 };
 
-// Timeline of phonemes for a spoken utterance
-struct PhonemeTimeline {
-    std::vector<Phoneme> phonemes;
-    double totalDuration;  // Total audio duration in seconds
-    QString text;          // Original text
+// How well lip-sync kept up with playback during one speech run
+struct LipSyncStats {
+    int phonemes = 0;               // Phonemes in the timeline
+    int shown = 0;                  // Phonemes reported through currentPhoneme
+    int skipped = 0;                // Phonemes that started and ended between two frames
+    int frames = 0;                 // updateLipSync() calls during playback
+    double maxFrameInterval = 0.0;  // Longest gap between frames (seconds)
+
+    double hitRate() const {
+        return (shown + skipped) > 0 ? static_cast<double>(shown) / (shown + skipped) : 1.0;
+    }
 };
 
 class TTSEngine : public QObject {
@@ -43,36 +68,82 @@ public:
     void setPiperPath(const QString& path);
     void setModelPath(const QString& path);
     void setVoiceSpeed(double speed);  // 1.0 = normal, 0.5 = slow, 2.0 = fast
+    void setWorkerIdleTimeout(int milliseconds);  // Piper process shutdown after idling (0 = never)
+    void setPhonemeTimingMode(PhonemeTimingMode mode);
+
+    // Synthesized sentences are stored in and replayed from this cache
+    // (nullptr disables it); may be shared with other components
+    void setAudioCache(std::shared_ptr<TtsCache> cache);
+    std::shared_ptr<TtsCache> audioCache() const { return m_audioCache; }
+
+    // Synthesize texts into the audio cache without playing them, one at a
+    // time whenever nothing is being spoken (requires Alignment timing)
+    void prewarm(const QStringList& texts);
+
+    // Resolve timelines to visemes as they are built (see visemeChanged);
+    // the mapper must outlive the engine or be reset to nullptr
+    void setVisemeMapper(const VisemeMapper* mapper);
 
     // Synthesis control
-    void synthesize(const QString& text);
-    void stop();
+    void synthesize(const QString& text);  // Stops current speech, then speaks text
+    void enqueue(const QString& text);     // Speaks text after everything already queued
+    void stop();                           // Stops playback and drops queued text
     bool isPlaying() const;
 
+    // Output format of the current voice (16-bit mono PCM)
+    int sampleRate() const { return m_sampleRate; }
+
+    // Lip-sync statistics of the current (or last) speech run
+    const LipSyncStats& lipSyncStats() const { return m_lipSyncStats; }
+
+public slots:
+    // Report the phoneme at the current playback position; call once per
+    // rendered frame (driven by the avatar's animation loop)
+    void updateLipSync();
+
 signals:
-    // Emitted when synthesis starts
+    // Emitted when the first utterance of a new speech run is queued
     void synthesisStarted();
 
-    // Emitted when audio playback starts, includes phoneme timeline
+    // Emitted once each utterance is fully synthesized (its playback has already
+    // started from the first audio chunk), includes its phoneme timeline
     void playbackStarted(const PhonemeTimeline& timeline);
 
     // Emitted periodically during playback with current phoneme
     void currentPhoneme(const Phoneme& phoneme, int index);
 
-    // Emitted when playback completes
+    // Emitted from updateLipSync() when the mouth shape changes (requires a viseme mapper)
+    void visemeChanged(const Viseme& viseme);
+
+    // Emitted when the last queued utterance finishes playing
     void playbackFinished();
 
     // Emitted on errors
     void errorOccurred(const QString& error);
 
 private slots:
-    void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
-    void onPlaybackStateChanged(QMediaPlayer::PlaybackState state);
-    void onPositionChanged(qint64 position);
+    void onAudioChunk(quint64 requestId, const QByteArray& pcm);
+    void onPhonemesAligned(quint64 requestId, const PhonemeAlignment& alignment);
+    void onAudioGenerated(quint64 requestId, bool success);
+    void feedAudioSink();
 
 private:
-    // Generate audio file using Piper
-    bool generateAudio(const QString& text, const QString& outputPath);
+    // Synthesize queued text in the background while the current utterance plays
+    void startNextSynthesis();
+    void startNextWarmup();
+    void finishWarmup(bool success);
+    bool playFromCache(const QString& text);
+    void storeInCache(const QString& text, const QByteArray& pcm, const PhonemeTimeline& timeline);
+    QString cacheKey(const QString& text) const;
+    void onSynthesisFinished(const SynthesizedUtterance& utterance, quint64 generation);
+    void finishSpeech();
+
+    // Audio output: PCM flows Piper -> ring buffer -> audio sink, never touching disk
+    void startPlayback();
+    void stopPlayback();
+    void logLipSyncStats() const;
+    void loadVoiceConfig();
+    double bytesToSeconds(qint64 bytes) const;
 
     // Extract phoneme timeline
     PhonemeTimeline extractPhonemeTimeline(const QString& text, double audioDuration);
@@ -81,18 +152,59 @@ private:
     void updateCurrentPhoneme(double currentTime);
 
 private:
-    std::unique_ptr<QMediaPlayer> m_mediaPlayer;
-    std::unique_ptr<QAudioOutput> m_audioOutput;
+    std::unique_ptr<QAudioSink> m_audioSink;
+    QIODevice* m_audioDevice;  // Push-mode device owned by m_audioSink
+    QTimer* m_feedTimer;
+    AudioRingBuffer m_audioBuffer;
+    QByteArray m_feedChunk;
+    qint64 m_streamBytes;      // PCM bytes queued for playback since playback started
+    int m_sampleRate;
+    AudioClock m_audioClock;   // Playback position between audio sink updates
+
     std::unique_ptr<PhonemeExtractor> m_phonemeExtractor;
+    std::unique_ptr<PiperWorker> m_piperWorker;
+    std::shared_ptr<TtsCache> m_audioCache;  // Shared with background cache writes
 
     QString m_piperPath;
     QString m_modelPath;
     QString m_espeakDataPath;
     double m_voiceSpeed;
+    PhonemeTimingMode m_timingMode;
 
-    PhonemeTimeline m_currentTimeline;
+    PhonemeTimeline m_currentTimeline;  // All utterances in the stream, in stream time
+    TimelineCursor m_timelineCursor;    // Lookup into m_currentTimeline
+    VisemeTrack m_visemeTrack;          // m_currentTimeline resolved to visemes
+    const VisemeMapper* m_visemeMapper;
+    int m_currentVisemeIndex;
     int m_currentPhonemeIndex;
+    int m_furthestPhonemeIndex;  // Highest index reported, for skip counting
     bool m_isPlaying;
+
+    // Lip-sync metrics
+    LipSyncStats m_lipSyncStats;
+    QElapsedTimer m_frameTimer;
+
+    // Sentence pipeline: texts waiting for synthesis
+    std::deque<QString> m_pendingTexts;
+    QFuture<SynthesizedUtterance> m_synthesisFuture;
+    bool m_synthesisInFlight;
+    bool m_speechActive;
+    quint64 m_generation;  // Bumped by stop() so stale results are dropped
+
+    // Utterance currently being synthesized by the Piper worker
+    QString m_inFlightText;
+    qint64 m_inFlightStreamOffset;  // Bytes
+    quint64 m_inFlightRequestId;
+    quint64 m_inFlightGeneration;
+    PhonemeAlignment m_inFlightAlignment;
+    QByteArray m_inFlightPcm;  // Kept for the audio cache
+
+    // Cache warm-up: texts waiting, and the one Piper is synthesizing
+    std::deque<QString> m_warmupTexts;
+    QString m_warmupText;
+    quint64 m_warmupRequestId;
+    QByteArray m_warmupPcm;
+    PhonemeAlignment m_warmupAlignment;
 };
 
 } // namespace Chatbot
@@ -0,0 +1,76 @@
+#include "tts/TimelineCursor.h"
+#include <algorithm>
+
+namespace Chatbot {
+
+namespace {
+// Phonemes to step forward linearly before switching to a binary search
+constexpr size_t kMaxLinearSteps = 4;
+}
+
+TimelineCursor::TimelineCursor()
+    : m_hint(0)
+    , m_current(-1)
+{
+}
+
+void TimelineCursor::append(const std::vector<Phoneme>& phonemes, double offset) {
+    for (const Phoneme& phoneme : phonemes) {
+        double start = offset + phoneme.startTime;
+        append(start, start + phoneme.duration);
+    }
+}
+
+void TimelineCursor::append(double startTime, double endTime) {
+    m_startTimes.push_back(static_cast<float>(startTime));
+    m_endTimes.push_back(static_cast<float>(endTime));
+}
+
+void TimelineCursor::extendLast(double endTime) {
+    if (!m_endTimes.empty()) {
+        m_endTimes.back() = static_cast<float>(endTime);
+    }
+}
+
+void TimelineCursor::clear() {
+    m_startTimes.clear();
+    m_endTimes.clear();
+    m_hint = 0;
+    m_current = -1;
+}
+
+int TimelineCursor::seek(double time) {
+    const size_t count = m_startTimes.size();
+    const float t = static_cast<float>(time);
+
+    if (count == 0 || t < m_startTimes.front()) {
+        m_hint = 0;
+        m_current = -1;
+        return m_current;
+    }
+
+    // Common case: a little after the last lookup
+    size_t index = std::min(m_hint, count - 1);
+    bool found = false;
+    if (m_startTimes[index] <= t) {
+        for (size_t step = 0; step < kMaxLinearSteps; ++step) {
+            if (index + 1 >= count || m_startTimes[index + 1] > t) {
+                found = true;
+                break;
+            }
+            ++index;
+        }
+    }
+
+    // Seek: last phoneme starting at or before t
+    if (!found) {
+        auto it = std::upper_bound(m_startTimes.begin(), m_startTimes.end(), t);
+        index = static_cast<size_t>(it - m_startTimes.begin()) - 1;
+    }
+
+    m_hint = index;
+    m_current = t < m_endTimes[index] ? static_cast<int>(index) : -1;
+    return m_current;
+}
+
+} // namespace Chatbot
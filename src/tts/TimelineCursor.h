@@ -0,0 +1,55 @@
+#ifndef CHATBOT_TIMELINECURSOR_H
+#define CHATBOT_TIMELINECURSOR_H
+
+#include "tts/PhonemeTimeline.h"
+#include <vector>
+
+namespace Chatbot {
+
+/**
+ * TimelineCursor finds the phoneme (or any other interval, see VisemeTrack)
+ * active at a playback time. Start and end
+ * times are kept in contiguous float arrays (struct-of-arrays) next to the
+ * timeline, and the cursor remembers the last index: during playback the
+ * time only moves forward by a frame or so, which costs a step or two from
+ * there. Jumps (backwards or far ahead) fall back to a binary search.
+ */
+class TimelineCursor {
+public:
+    TimelineCursor();
+    ~TimelineCursor() = default;
+
+    // Append phonemes whose times are relative to offset (seconds); appended
+    // phonemes must not start before those already in the cursor
+    void append(const std::vector<Phoneme>& phonemes, double offset = 0.0);
+    void append(double startTime, double endTime);
+
+    // Move the end of the last interval (to merge a following one into it)
+    void extendLast(double endTime);
+
+    // Drop all phonemes and reset the position
+    void clear();
+
+    // Index of the phoneme active at time, or -1 if none (gap or out of range)
+    int seek(double time);
+
+    // Index found by the last seek(), or -1
+    int currentIndex() const { return m_current; }
+
+    // Interval times by index (seconds)
+    float startTime(size_t index) const { return m_startTimes[index]; }
+    float endTime(size_t index) const { return m_endTimes[index]; }
+
+    size_t size() const { return m_startTimes.size(); }
+    bool isEmpty() const { return m_startTimes.empty(); }
+
+private:
+    std::vector<float> m_startTimes;  // Seconds, ascending
+    std::vector<float> m_endTimes;    // Seconds
+    size_t m_hint;                    // Last phoneme starting at or before the last seek time
+    int m_current;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_TIMELINECURSOR_H
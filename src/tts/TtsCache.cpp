@@ -0,0 +1,262 @@
+#include "tts/TtsCache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <cstring>
+#include <iterator>
+
+using json = nlohmann::json;
+
+namespace Chatbot {
+
+namespace {
+const char kMagic[4] = {'C', 'T', 'T', 'S'};
+constexpr quint32 kFormatVersion = 1;
+const QString kFileSuffix = ".utt";
+
+// Entry file: this header, the PCM, then the timeline as JSON. Native byte
+// order; the cache never leaves the machine that wrote it.
+struct FileHeader {
+    char magic[4];
+    quint32 version;
+    quint32 sampleRate;
+    quint32 timelineBytes;
+    quint64 pcmBytes;
+};
+}
+
+TtsCache::TtsCache(const QString& directory, qint64 byteBudget)
+    : m_directory(directory)
+    , m_byteBudget(byteBudget)
+    , m_bytes(0)
+{
+    if (!QDir().mkpath(m_directory)) {
+        spdlog::warn("Cannot create TTS cache directory {}", m_directory.toStdString());
+    }
+    loadIndex();
+}
+
+void TtsCache::setByteBudget(qint64 bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_byteBudget = bytes;
+    evictOverBudget();
+    spdlog::info("TTS cache budget set to {} MB", bytes / (1024 * 1024));
+}
+
+QString TtsCache::makeKey(const QString& text, const QString& modelPath, double lengthScale) {
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(text.trimmed().toUtf8());
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(QFileInfo(modelPath).absoluteFilePath().toUtf8());
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(QByteArray::number(lengthScale, 'g', 6));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+std::optional<CachedUtterance> TtsCache::lookup(const QString& key) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_entries.contains(key)) {
+            ++m_stats.misses;
+            return std::nullopt;
+        }
+    }
+
+    // The file is read without the lock, so a lookup on the GUI thread never
+    // waits for a worker writing another entry
+    std::optional<CachedUtterance> utterance;
+    auto file = std::make_shared<QFile>(entryPath(key));
+    if (file->open(QIODevice::ReadOnly)) {
+        // Mapped rather than read; the mapping lives as long as the QFile,
+        // which the result holds on to
+        if (uchar* data = file->map(0, file->size())) {
+            utterance = decode(data, file->size());
+        }
+        if (utterance) {
+            // Marks the entry as recently used, also for the next start
+            file->setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+            file->close();  // Maps stay valid until the QFile is destroyed
+            utterance->mapping = std::move(file);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!utterance) {
+        spdlog::warn("Dropping unreadable TTS cache entry {}", key.toStdString());
+        removeEntry(key);
+        ++m_stats.misses;
+        return std::nullopt;
+    }
+
+    // The entry may have been evicted meanwhile; the mapping stays valid
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->position);
+    }
+    ++m_stats.hits;
+    spdlog::debug("TTS cache hit ({:.0f}% of {} lookups)",
+                  m_stats.hitRate() * 100.0, m_stats.hits + m_stats.misses);
+    return utterance;
+}
+
+void TtsCache::insert(const QString& key, const CachedUtterance& utterance) {
+    if (utterance.pcm.isEmpty()) {
+        return;
+    }
+
+    // Encoded and written without the lock; only the index update takes it
+    QByteArray encoded = encode(utterance);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_entries.contains(key) || encoded.size() > m_byteBudget) {
+            return;
+        }
+    }
+
+    QSaveFile file(entryPath(key));
+    if (!file.open(QIODevice::WriteOnly) || file.write(encoded) != encoded.size() || !file.commit()) {
+        spdlog::warn("Failed to write TTS cache entry {}", key.toStdString());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.contains(key)) {
+        return;  // Another thread stored the same utterance meanwhile
+    }
+    m_lru.push_front(key);
+    m_entries.insert(key, Entry{encoded.size(), m_lru.begin()});
+    m_bytes += encoded.size();
+    evictOverBudget();
+}
+
+bool TtsCache::contains(const QString& key) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.contains(key);
+}
+
+void TtsCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (!m_lru.empty()) {
+        removeEntry(m_lru.back());
+    }
+    spdlog::info("TTS cache cleared");
+}
+
+TtsCacheStats TtsCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TtsCacheStats stats = m_stats;
+    stats.entries = static_cast<size_t>(m_entries.size());
+    stats.bytes = m_bytes;
+    return stats;
+}
+
+QString TtsCache::entryPath(const QString& key) const {
+    return m_directory + "/" + key + kFileSuffix;
+}
+
+void TtsCache::loadIndex() {
+    // Newest first, which is the usage order lookups maintain
+    QFileInfoList files = QDir(m_directory).entryInfoList({"*" + kFileSuffix}, QDir::Files, QDir::Time);
+    for (const QFileInfo& info : files) {
+        QString key = info.completeBaseName();
+        m_lru.push_back(key);
+        m_entries.insert(key, Entry{info.size(), std::prev(m_lru.end())});
+        m_bytes += info.size();
+    }
+    evictOverBudget();
+
+    spdlog::info("TTS cache: {} utterances ({} KB) in {}",
+                 m_entries.size(), m_bytes / 1024, m_directory.toStdString());
+}
+
+void TtsCache::removeEntry(const QString& key) {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    QFile::remove(entryPath(key));
+    m_bytes -= it->bytes;
+    m_lru.erase(it->position);
+    m_entries.erase(it);
+}
+
+void TtsCache::evictOverBudget() {
+    while (m_bytes > m_byteBudget && !m_lru.empty()) {
+        spdlog::debug("Evicting TTS cache entry {}", m_lru.back().toStdString());
+        removeEntry(m_lru.back());
+    }
+}
+
+QByteArray TtsCache::encode(const CachedUtterance& utterance) {
+    json phonemes = json::array();
+    for (const Phoneme& phoneme : utterance.timeline.phonemes) {
+        phonemes.push_back({phoneme.symbol.toStdString(), phoneme.id, phoneme.startTime, phoneme.duration});
+    }
+    std::string timeline = json{
+        {"text", utterance.timeline.text.toStdString()},
+        {"duration", utterance.timeline.totalDuration},
+        {"phonemes", phonemes}
+    }.dump();
+
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.sampleRate = static_cast<quint32>(utterance.sampleRate);
+    header.timelineBytes = static_cast<quint32>(timeline.size());
+    header.pcmBytes = static_cast<quint64>(utterance.pcm.size());
+
+    QByteArray encoded;
+    encoded.reserve(static_cast<qsizetype>(sizeof(header) + utterance.pcm.size() + timeline.size()));
+    encoded.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    encoded.append(utterance.pcm);
+    encoded.append(timeline.data(), static_cast<qsizetype>(timeline.size()));
+    return encoded;
+}
+
+std::optional<CachedUtterance> TtsCache::decode(const uchar* data, qint64 size) {
+    FileHeader header;
+    if (size < static_cast<qint64>(sizeof(header))) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion
+        || static_cast<quint64>(size) != sizeof(header) + header.pcmBytes + header.timelineBytes) {
+        return std::nullopt;
+    }
+
+    const char* pcm = reinterpret_cast<const char*>(data) + sizeof(header);
+    const char* timeline = pcm + header.pcmBytes;
+    json stored = json::parse(timeline, timeline + header.timelineBytes, nullptr, false);
+    if (stored.is_discarded() || !stored.is_object()) {
+        return std::nullopt;
+    }
+
+    CachedUtterance utterance;
+    utterance.pcm = QByteArray::fromRawData(pcm, static_cast<qsizetype>(header.pcmBytes));
+    utterance.sampleRate = static_cast<int>(header.sampleRate);
+
+    try {
+        utterance.timeline.text = QString::fromStdString(stored.value("text", ""));
+        utterance.timeline.totalDuration = stored.value("duration", 0.0);
+
+        for (const json& item : stored.value("phonemes", json::array())) {
+            Phoneme phoneme;
+            phoneme.symbol = QString::fromStdString(item.at(0).get<std::string>());
+            phoneme.id = item.at(1).get<int>();
+            phoneme.startTime = item.at(2).get<double>();
+            phoneme.duration = item.at(3).get<double>();
+            utterance.timeline.phonemes.push_back(phoneme);
+        }
+    } catch (const json::exception&) {
+        return std::nullopt;
+    }
+    return utterance;
+}
+
+} // namespace Chatbot
@@ -0,0 +1,106 @@
+#ifndef CHATBOT_TTSCACHE_H
+#define CHATBOT_TTSCACHE_H
+
+#include "tts/PhonemeTimeline.h"
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+class QFile;
+
+namespace Chatbot {
+
+// A synthesized utterance as stored in the cache
+struct CachedUtterance {
+    QByteArray pcm;            // 16-bit mono PCM
+    int sampleRate = 0;
+    PhonemeTimeline timeline;  // Times relative to the utterance start
+
+    // Set on lookup results: pcm points into this file's memory mapping
+    // (QByteArray::fromRawData) and is only valid while it is held
+    std::shared_ptr<QFile> mapping;
+};
+
+// Counters since the cache was created
+struct TtsCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t entries = 0;
+    qint64 bytes = 0;  // On disk
+
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+};
+
+/**
+ * TtsCache stores synthesized speech on disk so that repeated utterances
+ * (canned phrases, greetings, short answers) skip Piper and
+ * piper_phonemize entirely. Entries are content-addressed by a hash of
+ * the text, the voice model and the length scale, one file per entry
+ * holding the PCM and the phoneme timeline. Lookups return the PCM in
+ * place in the memory-mapped file, without reading or copying it, and
+ * entries survive restarts. Files are only ever replaced, never rewritten,
+ * so a mapping stays valid while an entry is evicted or overwritten.
+ *
+ * The least recently used entries are deleted once the files exceed the
+ * byte budget; file modification times keep the usage order across
+ * restarts.
+ *
+ * Thread-safe: entries may be added from worker threads. Files are read
+ * and written outside the lock, which only guards the index.
+ */
+class TtsCache {
+public:
+    explicit TtsCache(const QString& directory = "./cache/tts", qint64 byteBudget = 64 * 1024 * 1024);
+    ~TtsCache() = default;
+
+    // Delete copy constructor and assignment operator
+    TtsCache(const TtsCache&) = delete;
+    TtsCache& operator=(const TtsCache&) = delete;
+
+    void setByteBudget(qint64 bytes);
+
+    static QString makeKey(const QString& text, const QString& modelPath, double lengthScale);
+
+    std::optional<CachedUtterance> lookup(const QString& key);
+    void insert(const QString& key, const CachedUtterance& utterance);
+    bool contains(const QString& key) const;
+    void clear();
+
+    TtsCacheStats stats() const;
+
+private:
+    struct Entry {
+        qint64 bytes = 0;
+        std::list<QString>::iterator position;  // In m_lru
+    };
+
+    QString entryPath(const QString& key) const;
+    void loadIndex();
+    void removeEntry(const QString& key);  // Caller holds m_mutex
+    void evictOverBudget();                // Caller holds m_mutex
+
+    static QByteArray encode(const CachedUtterance& utterance);
+    // The PCM is not copied: utterance.pcm refers to data
+    static std::optional<CachedUtterance> decode(const uchar* data, qint64 size);
+
+private:
+    mutable std::mutex m_mutex;
+    QString m_directory;
+    qint64 m_byteBudget;
+    qint64 m_bytes;
+    std::list<QString> m_lru;  // Keys, most recently used first
+    QHash<QString, Entry> m_entries;
+    TtsCacheStats m_stats;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_TTSCACHE_H
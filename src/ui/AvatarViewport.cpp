@@ -151,9 +151,12 @@ void AvatarViewport::onAnimationTick() {
     float deltaTime = (currentTime - m_lastFrameTime) / 1000.0f;  // Convert to seconds
     m_lastFrameTime = currentTime;
 
-    // Update avatar animation
+    emit animationTick(deltaTime);
+
+    // Update avatar animation, then push this frame's pose to Qt3D in one go
     if (m_avatarEngine) {
         m_avatarEngine->updateAnimation(deltaTime);
+        m_avatarEngine->flushPose();
     }
 }
 
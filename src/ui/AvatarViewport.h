@@ -37,6 +37,11 @@ public:
     // Get the avatar engine for external control
     AvatarEngine* getAvatarEngine() const { return m_avatarEngine.get(); }
 
+signals:
+    // Emitted every frame before the avatar is animated, so per-frame
+    // inputs (lip-sync) can be updated in step with rendering
+    void animationTick(float deltaTime);
+
 private:
     void setup3DScene();
     void setupCamera();
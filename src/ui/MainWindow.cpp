@@ -2,8 +2,10 @@
 #include "ui/AvatarViewport.h"
 #include <QApplication>
 #include <QScreen>
+#include <QShortcut>
 #include <QDateTime>
 #include <QSplitter>
+#include <QTextCharFormat>
 #include <spdlog/spdlog.h>
 
 namespace Chatbot {
@@ -25,6 +27,7 @@ MainWindow::MainWindow(QWidget *parent)
     , m_inputLayout(nullptr)
     , m_inputField(nullptr)
     , m_sendButton(nullptr)
+    , m_botMessageInProgress(false)
 {
     setupUI();
     setupConnections();
@@ -182,6 +185,9 @@ void MainWindow::setupConnections() {
     connect(m_inputField, &QLineEdit::returnPressed, this, &MainWindow::onInputReturnPressed);
     connect(m_personalitySelector, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &MainWindow::onPersonalityChanged);
+
+    QShortcut* stopShortcut = new QShortcut(QKeySequence(Qt::Key_Escape), this);
+    connect(stopShortcut, &QShortcut::activated, this, &MainWindow::stopRequested);
 }
 
 void MainWindow::onSendButtonClicked() {
@@ -213,6 +219,8 @@ void MainWindow::clearInput() {
 }
 
 void MainWindow::addUserMessage(const QString& message) {
+    m_botMessageInProgress = false;
+
     QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
     QString html = QString(
         "<div style='margin-bottom: 10px;'>"
@@ -227,6 +235,12 @@ void MainWindow::addUserMessage(const QString& message) {
 }
 
 void MainWindow::addBotMessage(const QString& message) {
+    if (m_botMessageInProgress) {
+        // Already displayed chunk by chunk
+        m_botMessageInProgress = false;
+        return;
+    }
+
     QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
     QString html = QString(
         "<div style='margin-bottom: 10px;'>"
@@ -240,6 +254,39 @@ void MainWindow::addBotMessage(const QString& message) {
     m_chatDisplay->ensureCursorVisible();
 }
 
+void MainWindow::appendBotMessageDelta(const QString& delta) {
+    if (!m_botMessageInProgress) {
+        QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
+        QString html = QString(
+            "<div style='margin-bottom: 10px;'>"
+            "  <span style='color: #888; font-size: 12px;'>%1</span><br>"
+            "  <span style='color: #4CAF50; font-weight: bold;'>Bot:</span> "
+            "</div>"
+        ).arg(timestamp);
+
+        m_chatDisplay->append(html);
+        m_botMessageInProgress = true;
+
+        m_botMessageCursor = QTextCursor(m_chatDisplay->document());
+        m_botMessageCursor.movePosition(QTextCursor::End);
+        m_botMessageCursor.setKeepPositionOnInsert(true);
+    }
+
+    // Plain text insert at the end of the bot message, in normal message style
+    QTextCharFormat format;
+    format.setForeground(QColor("#000"));
+    format.setFontWeight(QFont::Normal);
+
+    int position = m_botMessageCursor.position();
+    m_botMessageCursor.insertText(delta, format);
+    m_botMessageCursor.setPosition(position + delta.length());
+    m_chatDisplay->ensureCursorVisible();
+}
+
+void MainWindow::cancelBotMessage() {
+    m_botMessageInProgress = false;
+}
+
 void MainWindow::addSystemMessage(const QString& message) {
     QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
     QString html = QString(
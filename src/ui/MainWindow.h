@@ -10,6 +10,7 @@
 #include <QSplitter>
 #include <QComboBox>
 #include <QLabel>
+#include <QTextCursor>
 
 namespace Chatbot {
 
@@ -28,6 +29,13 @@ public:
     void addBotMessage(const QString& message);
     void addSystemMessage(const QString& message);
 
+    // Append streamed text to the bot message currently being received.
+    // The following addBotMessage() call completes it instead of adding a new one.
+    void appendBotMessageDelta(const QString& delta);
+
+    // End the streamed bot message early (reply cancelled); no addBotMessage() follows
+    void cancelBotMessage();
+
     // Get avatar viewport
     AvatarViewport* getAvatarViewport() const { return m_avatarViewport; }
 
@@ -37,6 +45,7 @@ public:
 signals:
     void userMessageSubmitted(const QString& message);
     void personalitySelected(const QString& personalityName);
+    void stopRequested();  // Escape: interrupt the reply and speech
 
 private slots:
     void onSendButtonClicked();
@@ -73,6 +82,11 @@ private:
     QHBoxLayout* m_inputLayout;
     QLineEdit* m_inputField;
     QPushButton* m_sendButton;
+
+    // Streaming state (cursor stays at the end of the bot message being received,
+    // so system messages appended meanwhile don't split it)
+    bool m_botMessageInProgress;
+    QTextCursor m_botMessageCursor;
 };
 
 } // namespace Chatbot
@@ -0,0 +1,116 @@
+#include "avatar/VisemeTrack.h"
+#include <QFile>
+#include <QTemporaryDir>
+#include <gtest/gtest.h>
+#include <initializer_list>
+#include <tuple>
+
+namespace Chatbot {
+namespace {
+
+constexpr const char* kMapping = R"({
+  "visemes": {
+    "PP": { "id": 1, "mouth_width": 0.0, "mouth_height": 0.0, "jaw_open": 0.0 },
+    "aa": { "id": 2, "mouth_width": 0.6, "mouth_height": 0.8, "jaw_open": 0.7 }
+  },
+  "phoneme_to_viseme": { "p": "PP", "b": "PP", "m": "PP", "a": "aa" }
+})";
+
+class VisemeTrackTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        QString path = m_dir.filePath("viseme_mapping.json");
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(kMapping);
+        file.close();
+        ASSERT_TRUE(m_mapper.loadMapping(path));
+
+        m_lips = m_mapper.visemeIndexForPhoneme("m");
+        m_open = m_mapper.visemeIndexForPhoneme("a");
+        ASSERT_NE(m_lips, VisemeMapper::kSilenceIndex);
+        ASSERT_NE(m_open, VisemeMapper::kSilenceIndex);
+    }
+
+    // Timeline of (symbol, start, end) phonemes
+    static PhonemeTimeline timeline(std::initializer_list<std::tuple<const char*, double, double>> phonemes) {
+        PhonemeTimeline result;
+        for (const auto& [symbol, start, end] : phonemes) {
+            result.phonemes.push_back({symbol, 0, start, end - start});
+        }
+        return result;
+    }
+
+    QTemporaryDir m_dir;
+    VisemeMapper m_mapper;
+    int m_lips = 0;
+    int m_open = 0;
+};
+
+TEST_F(VisemeTrackTest, SameVisemeRunBecomesOneKey) {
+    VisemeTrack track;
+    track.append(timeline({{"m", 0.0, 0.1}, {"b", 0.1, 0.2}, {"a", 0.2, 0.3}}), 0.0, m_mapper);
+
+    ASSERT_EQ(track.keyCount(), 2u);
+    EXPECT_EQ(track.keyViseme(0), m_lips);
+    EXPECT_DOUBLE_EQ(track.keyStart(0), 0.0);
+    EXPECT_NEAR(track.keyEnd(0), 0.2, 1e-6);
+    EXPECT_EQ(track.keyViseme(1), m_open);
+
+    EXPECT_EQ(track.sample(0.15), m_lips);
+    EXPECT_EQ(track.sample(0.25), m_open);
+}
+
+TEST_F(VisemeTrackTest, SameVisemeMergesAcrossAShortGap) {
+    VisemeTrack track;
+    track.append(timeline({{"m", 0.0, 0.1}, {"p", 0.115, 0.2}}), 0.0, m_mapper);
+
+    ASSERT_EQ(track.keyCount(), 1u);
+    EXPECT_NEAR(track.keyEnd(0), 0.2, 1e-6);
+    EXPECT_EQ(track.sample(0.107), m_lips);  // Inside the gap: the lips stay closed
+}
+
+TEST_F(VisemeTrackTest, LongerGapsKeepSeparateKeysWithSilenceBetween) {
+    VisemeTrack track;
+    track.append(timeline({{"m", 0.0, 0.1}, {"p", 0.15, 0.2}}), 0.0, m_mapper);
+
+    ASSERT_EQ(track.keyCount(), 2u);
+    EXPECT_EQ(track.sample(0.12), VisemeMapper::kSilenceIndex);
+    EXPECT_EQ(track.sample(0.17), m_lips);
+}
+
+TEST_F(VisemeTrackTest, DifferentVisemesAreNotMerged) {
+    VisemeTrack track;
+    track.append(timeline({{"m", 0.0, 0.1}, {"a", 0.11, 0.2}}), 0.0, m_mapper);
+
+    ASSERT_EQ(track.keyCount(), 2u);
+    EXPECT_EQ(track.sample(0.105), VisemeMapper::kSilenceIndex);
+}
+
+TEST_F(VisemeTrackTest, RunsMergeAcrossUtterances) {
+    VisemeTrack track;
+    track.append(timeline({{"a", 0.0, 0.1}, {"m", 0.1, 0.2}}), 0.0, m_mapper);
+    track.append(timeline({{"b", 0.0, 0.1}, {"a", 0.1, 0.2}}), 0.21, m_mapper);
+
+    ASSERT_EQ(track.keyCount(), 3u);
+    EXPECT_NEAR(track.keyEnd(1), 0.31, 1e-6);
+    EXPECT_EQ(track.sample(0.205), m_lips);
+    EXPECT_EQ(track.sample(0.35), m_open);
+}
+
+TEST_F(VisemeTrackTest, ClearDropsEveryKey) {
+    VisemeTrack track;
+    track.append(timeline({{"m", 0.0, 0.1}}), 0.0, m_mapper);
+    track.clear();
+
+    EXPECT_TRUE(track.isEmpty());
+    EXPECT_EQ(track.sample(0.05), VisemeMapper::kSilenceIndex);
+
+    // No merge with the cleared key
+    track.append(timeline({{"m", 0.0, 0.1}}), 0.0, m_mapper);
+    EXPECT_EQ(track.keyCount(), 1u);
+}
+
+} // namespace
+} // namespace Chatbot
@@ -0,0 +1,134 @@
+// Latency benchmark: a multi-turn conversation against the fake Ollama
+// server in /api/generate and /api/chat mode. The server only "evaluates"
+// the prompt tokens that differ from the previous request (like Ollama's KV
+// cache) and takes a fixed time per evaluated token, so the reply latency
+// follows how much of each prompt could be reused.
+//
+//   chat_latency_benchmark [turns] [ms per evaluated token]
+
+#include "chat/ChatEngine.h"
+#include "chat/ResponseCache.h"
+#include "support/FakeOllamaServer.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+#include <spdlog/spdlog.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Chatbot;
+
+namespace {
+
+constexpr int kTurnTimeoutMs = 60000;
+
+struct Turn {
+    qint64 latencyMs = -1;  // -1: failed or timed out
+    int promptTokens = 0;
+    int evaluated = 0;
+};
+
+std::vector<Turn> runConversation(ApiMode mode, int turns, double evalDelayMs) {
+    FakeOllamaServer server;
+    server.setEvalDelayPerToken(evalDelayMs);
+    server.setReply({"Sure. ", "Here is a fairly ordinary answer ", "of a few sentences, ",
+                     "about as long as the replies the avatar usually speaks. ",
+                     "It ends with a question to keep the conversation going?"});
+    if (!server.start()) {
+        std::fprintf(stderr, "Could not start the fake Ollama server\n");
+        return {};
+    }
+
+    ChatEngine engine;
+    engine.setOllamaUrl(server.url());
+    engine.setApiMode(mode);
+    engine.setSummaryThreshold(0);  // Only the turns themselves
+    engine.responseCache()->setMaxEntries(0);  // Every turn goes to the server
+    engine.setSystemPrompt("You are a friendly assistant with an animated avatar. Keep answers "
+                           "short and conversational, avoid lists and code blocks, and ask a "
+                           "follow-up question when it helps the user.");
+
+    std::vector<Turn> results;
+    for (int i = 0; i < turns; ++i) {
+        QEventLoop loop;
+        bool ok = false;
+        auto received = QObject::connect(&engine, &ChatEngine::responseReceived, &loop, [&]() {
+            ok = true;
+            loop.quit();
+        });
+        auto failed = QObject::connect(&engine, &ChatEngine::errorOccurred, &loop, &QEventLoop::quit);
+        QTimer::singleShot(kTurnTimeoutMs, &loop, &QEventLoop::quit);
+
+        QElapsedTimer timer;
+        timer.start();
+        engine.sendMessage(QString("Question %1: what else should I know about topic %1?").arg(i + 1));
+        loop.exec();
+
+        Turn turn;
+        turn.latencyMs = ok ? timer.elapsed() : -1;
+        if (!server.requests().empty()) {
+            turn.promptTokens = server.requests().back().promptTokens;
+            turn.evaluated = server.requests().back().evaluated;
+        }
+        results.push_back(turn);
+
+        QObject::disconnect(received);
+        QObject::disconnect(failed);
+    }
+    return results;
+}
+
+void printSummary(const char* name, const std::vector<Turn>& turns) {
+    qint64 latency = 0;
+    long long prompt = 0;
+    long long evaluated = 0;
+    int failures = 0;
+    for (const Turn& turn : turns) {
+        if (turn.latencyMs < 0) {
+            failures++;
+            continue;
+        }
+        latency += turn.latencyMs;
+        prompt += turn.promptTokens;
+        evaluated += turn.evaluated;
+    }
+
+    int completed = static_cast<int>(turns.size()) - failures;
+    double reuse = prompt > 0 ? 100.0 * (prompt - evaluated) / prompt : 0.0;
+    std::printf("%-9s mean latency %6.1f ms, %lld of %lld prompt tokens evaluated (%.1f%% reused)%s\n",
+                name, completed > 0 ? static_cast<double>(latency) / completed : 0.0,
+                evaluated, prompt, reuse, failures > 0 ? ", some turns FAILED" : "");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    spdlog::set_level(spdlog::level::warn);
+
+    int turns = argc > 1 ? std::atoi(argv[1]) : 12;
+    double evalDelayMs = argc > 2 ? std::atof(argv[2]) : 0.5;
+    if (turns <= 0) {
+        turns = 12;
+    }
+
+    std::vector<Turn> generate = runConversation(ApiMode::Generate, turns, evalDelayMs);
+    std::vector<Turn> chat = runConversation(ApiMode::Chat, turns, evalDelayMs);
+
+    std::printf("%4s | %28s | %28s\n", "", "/api/generate", "/api/chat");
+    std::printf("%4s | %8s %9s %9s | %8s %9s %9s\n",
+                "turn", "ms", "prompt", "evaluated", "ms", "prompt", "evaluated");
+    for (int i = 0; i < turns; ++i) {
+        Turn g = i < static_cast<int>(generate.size()) ? generate[i] : Turn{};
+        Turn c = i < static_cast<int>(chat.size()) ? chat[i] : Turn{};
+        std::printf("%4d | %8lld %9d %9d | %8lld %9d %9d\n", i + 1,
+                    static_cast<long long>(g.latencyMs), g.promptTokens, g.evaluated,
+                    static_cast<long long>(c.latencyMs), c.promptTokens, c.evaluated);
+    }
+    std::printf("\n");
+    printSummary("generate", generate);
+    printSummary("chat", chat);
+    return 0;
+}
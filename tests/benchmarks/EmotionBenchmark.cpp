@@ -0,0 +1,125 @@
+// Micro-benchmark: keyword scoring of long LLM replies, the per-keyword
+// indexOf scan EmotionDetector used before against the keyword automaton.
+//
+//   emotion_benchmark [iterations]   (per 2000 characters of reply, default 200)
+
+#include "emotion/EmotionDetector.h"
+#include "emotion/KeywordAutomaton.h"
+#include <QElapsedTimer>
+#include <QStringList>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace Chatbot;
+
+namespace {
+
+// The scan the automaton replaced: every keyword of every emotion searched
+// separately, substrings included ("good" in "goodbye")
+std::vector<int> indexOfScan(const QString& text, const QMap<Emotion, QStringList>& lists, int categories) {
+    std::vector<int> scores(static_cast<size_t>(categories), 0);
+    QString lowerText = text.toLower();
+    for (auto it = lists.constBegin(); it != lists.constEnd(); ++it) {
+        int count = 0;
+        for (QString keyword : it.value()) {
+            if (keyword.endsWith('*')) {
+                keyword.chop(1);
+            }
+            qsizetype index = 0;
+            while ((index = lowerText.indexOf(keyword, index, Qt::CaseInsensitive)) != -1) {
+                count++;
+                index += keyword.length();
+            }
+        }
+        scores[static_cast<size_t>(it.key())] = count;
+    }
+    return scores;
+}
+
+// Reply-like prose: mostly filler words, some keywords and near misses
+QString makeReply(int chars, unsigned seed) {
+    static const QStringList words = {
+        "the", "a", "to", "of", "and", "in", "that", "it", "is", "for", "you",
+        "this", "with", "on", "as", "can", "your", "be", "are", "or", "if",
+        "model", "example", "function", "value", "returns", "memory", "system",
+        "first", "then", "which", "because", "when", "each", "data", "into",
+        "good", "goodbye", "hard", "hardware", "think", "problem", "great",
+        "concerned", "really", "perhaps", "sorry", "interesting", "enjoying"
+    };
+    static const QStringList punctuation = {" ", " ", " ", " ", " ", ", ", ". ", ".\n\n", "? ", "! "};
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> word(0, static_cast<int>(words.size()) - 1);
+    std::uniform_int_distribution<int> separator(0, static_cast<int>(punctuation.size()) - 1);
+
+    QString text;
+    text.reserve(chars + 32);
+    while (text.size() < chars) {
+        text += words[word(rng)];
+        text += punctuation[separator(rng)];
+    }
+    return text;
+}
+
+template <typename Scan>
+double nanosecondsPerChar(const QString& text, int iterations, Scan scan, int& total) {
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        std::vector<int> scores = scan(text);
+        total = 0;
+        for (int score : scores) {
+            total += score;
+        }
+    }
+    return static_cast<double>(timer.nsecsElapsed()) / iterations / text.size();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+    if (iterations <= 0) {
+        iterations = 200;
+    }
+    spdlog::set_level(spdlog::level::warn);
+
+    // Same keywords the detector compiles
+    EmotionDetector detector;
+    const QMap<Emotion, QStringList>& lists = detector.getKeywordLists();
+    KeywordAutomaton automaton;
+    for (auto it = lists.constBegin(); it != lists.constEnd(); ++it) {
+        for (const QString& keyword : it.value()) {
+            automaton.addKeyword(keyword, static_cast<int>(it.key()));
+        }
+    }
+    automaton.build();
+    const int categories = automaton.categoryCount();
+
+    std::printf("%10s %14s %15s %9s %14s\n", "chars", "indexOf ns/ch", "automaton ns/ch",
+                "speedup", "matches (i/a)");
+    for (int chars : {500, 2000, 10000, 50000}) {
+        QString reply = makeReply(chars, 42);
+        int runs = std::max(1, iterations * 2000 / chars);
+
+        int indexOfMatches = 0;
+        int automatonMatches = 0;
+        double before = nanosecondsPerChar(reply, runs, [&](const QString& text) {
+            return indexOfScan(text, lists, categories);
+        }, indexOfMatches);
+        double after = nanosecondsPerChar(reply, runs, [&](const QString& text) {
+            std::vector<int> scores(static_cast<size_t>(categories), 0);
+            automaton.count(text, scores.data());
+            return scores;
+        }, automatonMatches);
+
+        // Match counts differ: the old scan also counted keywords inside words
+        std::printf("%10lld %14.2f %15.2f %8.1fx %7d/%d\n", static_cast<long long>(reply.size()),
+                    before, after, before / after, indexOfMatches, automatonMatches);
+    }
+    return 0;
+}
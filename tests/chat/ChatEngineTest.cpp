@@ -0,0 +1,122 @@
+#include "chat/ChatEngine.h"
+#include "chat/ChatSession.h"
+#include "chat/ConversationHistory.h"
+#include "chat/ResponseCache.h"
+#include "support/FakeOllamaServer.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace Chatbot {
+namespace {
+
+constexpr int kTimeoutMs = 5000;
+
+class ChatEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_server.start());
+        m_engine.setOllamaUrl(m_server.url());
+        m_engine.setSummaryThreshold(0);  // Only the requests each test makes
+    }
+
+    FakeOllamaServer m_server;
+    ChatEngine m_engine;  // Destroyed first, while the server can still answer
+};
+
+TEST_F(ChatEngineTest, StreamedReplyArrivesInChunks) {
+    QSignalSpy partial(&m_engine, &ChatEngine::partialResponseReceived);
+    QSignalSpy response(&m_engine, &ChatEngine::responseReceived);
+    QSignalSpy error(&m_engine, &ChatEngine::errorOccurred);
+
+    m_engine.sendMessage("Hi");
+    ASSERT_TRUE(response.wait(kTimeoutMs));
+
+    ASSERT_EQ(partial.count(), 3);
+    EXPECT_EQ(partial.at(0).at(0).toString(), "Hello");
+    EXPECT_EQ(partial.at(2).at(0).toString(), "!");
+    EXPECT_EQ(response.at(0).at(0).toString(), "Hello there!");
+    EXPECT_EQ(error.count(), 0);
+    EXPECT_EQ(m_engine.defaultSession()->history().messageCount(), 2u);
+}
+
+TEST_F(ChatEngineTest, StreamCutOffBeforeDoneIsAnError) {
+    m_server.setTruncateStream(true);
+    QSignalSpy response(&m_engine, &ChatEngine::responseReceived);
+    QSignalSpy error(&m_engine, &ChatEngine::errorOccurred);
+
+    m_engine.sendMessage("Hi");
+    ASSERT_TRUE(error.wait(kTimeoutMs));
+
+    EXPECT_EQ(response.count(), 0);
+    EXPECT_EQ(m_engine.defaultSession()->history().messageCount(), 1u);  // No partial reply kept
+    EXPECT_EQ(m_engine.responseCache()->stats().entries, 0u);            // Nor cached
+}
+
+TEST_F(ChatEngineTest, StreamErrorChunkIsAnError) {
+    m_server.setError("model not found");
+    QSignalSpy response(&m_engine, &ChatEngine::responseReceived);
+    QSignalSpy error(&m_engine, &ChatEngine::errorOccurred);
+
+    m_engine.sendMessage("Hi");
+    ASSERT_TRUE(error.wait(kTimeoutMs));
+    EXPECT_EQ(response.count(), 0);
+}
+
+TEST_F(ChatEngineTest, NonStreamingReplyArrivesWhole) {
+    m_engine.setStreamingEnabled(false);
+    QSignalSpy partial(&m_engine, &ChatEngine::partialResponseReceived);
+    QSignalSpy response(&m_engine, &ChatEngine::responseReceived);
+
+    m_engine.sendMessage("Hi");
+    ASSERT_TRUE(response.wait(kTimeoutMs));
+
+    EXPECT_EQ(partial.count(), 0);
+    EXPECT_EQ(response.at(0).at(0).toString(), "Hello there!");
+    ASSERT_EQ(m_server.requests().size(), 1u);
+    EXPECT_FALSE(m_server.requests()[0].body.value("stream", true));
+}
+
+TEST_F(ChatEngineTest, FollowUpRequestReusesThePromptPrefix) {
+    QSignalSpy response(&m_engine, &ChatEngine::responseReceived);
+
+    m_engine.sendMessage("What is the capital of France?");
+    ASSERT_TRUE(response.wait(kTimeoutMs));
+    m_engine.sendMessage("And of Italy?");
+    ASSERT_TRUE(response.wait(kTimeoutMs));
+
+    ASSERT_EQ(m_server.requests().size(), 2u);
+    const FakeOllamaRequest& followUp = m_server.requests()[1];
+    EXPECT_EQ(followUp.path, "/api/chat");
+    EXPECT_EQ(followUp.body["messages"][0]["role"], "system");
+    EXPECT_LT(followUp.evaluated, followUp.promptTokens);
+}
+
+TEST(ChatEngineShutdownTest, DestructorAbortsAndWaitsForRunningRequests) {
+    FakeOllamaServer server;
+    ASSERT_TRUE(server.start());
+    server.setEvalDelayPerToken(1000.0);  // Never answers within the test
+
+    auto engine = std::make_unique<ChatEngine>();
+    engine->setOllamaUrl(server.url());
+    engine->setSummaryThreshold(0);
+    engine->sendMessage("Hi, how are you?");
+
+    QElapsedTimer timer;
+    timer.start();
+    while (server.requests().empty() && timer.elapsed() < kTimeoutMs) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    ASSERT_EQ(server.requests().size(), 1u);
+
+    // The worker is blocked in curl; the destructor must abort it and only
+    // return once it no longer uses the engine
+    timer.restart();
+    engine.reset();
+    EXPECT_LT(timer.elapsed(), kTimeoutMs);
+}
+
+} // namespace
+} // namespace Chatbot
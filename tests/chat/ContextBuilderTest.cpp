@@ -0,0 +1,121 @@
+#include "chat/ContextBuilder.h"
+#include "chat/ConversationHistory.h"
+#include <gtest/gtest.h>
+#include <string>
+
+namespace Chatbot {
+namespace {
+
+// 36 characters: 9 estimated tokens, 13 with the per-message overhead
+const QString kMessage(36, QChar('x'));
+constexpr int kMessageCost = 13;
+constexpr int kEmptySystemPromptCost = 4;
+
+void addMessages(ConversationHistory& history, int count) {
+    for (int i = 0; i < count; ++i) {
+        history.addUserMessage(kMessage);
+    }
+}
+
+TEST(ContextBuilderTest, UnlimitedBudgetIncludesEveryMessage) {
+    ConversationHistory history;
+    addMessages(history, 20);
+
+    ContextBuilder builder;
+    builder.setTokenBudget(0);
+    ContextWindow window = builder.select(history, "");
+
+    EXPECT_EQ(window.firstIndex, 0u);
+    EXPECT_EQ(window.messagesIncluded, 20u);
+    EXPECT_EQ(window.messagesDropped, 0u);
+    EXPECT_EQ(window.estimatedTokens, kEmptySystemPromptCost + 20 * kMessageCost);
+}
+
+TEST(ContextBuilderTest, OverBudgetTheStartJumpsToFreeHalfTheBudget) {
+    ConversationHistory history;
+    ContextBuilder builder;
+    builder.setTokenBudget(100);
+
+    // 4 + 7 * 13 = 95 tokens: everything fits
+    addMessages(history, 7);
+    ContextWindow window = builder.select(history, "");
+    EXPECT_EQ(window.firstIndex, 0u);
+    EXPECT_EQ(window.estimatedTokens, 95);
+
+    // 108 tokens: drop the oldest until at most 50 remain (five messages)
+    addMessages(history, 1);
+    window = builder.select(history, "");
+    EXPECT_EQ(window.firstIndex, 5u);
+    EXPECT_EQ(window.messagesIncluded, 3u);
+    EXPECT_EQ(window.messagesDropped, 5u);
+    EXPECT_EQ(window.estimatedTokens, 43);
+    EXPECT_LE(window.estimatedTokens, builder.tokenBudget() / 2);
+}
+
+TEST(ContextBuilderTest, WindowStartStaysPutWhileTheBudgetHolds) {
+    ConversationHistory history;
+    ContextBuilder builder;
+    builder.setTokenBudget(100);
+    addMessages(history, 8);
+    ContextWindow window = builder.select(history, "system");
+    size_t start = window.firstIndex;
+    nlohmann::json previous = builder.buildMessages(history, window, "system");
+
+    // Each turn only appends to the previous request's messages
+    for (int turn = 0; turn < 3; ++turn) {
+        addMessages(history, 1);
+        window = builder.select(history, "system");
+        EXPECT_EQ(window.firstIndex, start);
+
+        nlohmann::json messages = builder.buildMessages(history, window, "system");
+        ASSERT_EQ(messages.size(), previous.size() + 1);
+        for (size_t i = 0; i < previous.size(); ++i) {
+            EXPECT_EQ(messages[i], previous[i]);
+        }
+        previous = messages;
+    }
+}
+
+TEST(ContextBuilderTest, SystemPromptAndSummaryGoFirst) {
+    ConversationHistory history;
+    history.addUserMessage("hello");
+    history.addBotMessage("hi there");
+    history.addUserMessage("how are you?");
+    history.setSummary("They greeted each other.", history.at(1).sequence);
+
+    ContextBuilder builder;
+    builder.setTokenBudget(0);
+    ContextWindow window = builder.select(history, "Be brief.");
+    EXPECT_TRUE(window.includesSummary);
+    EXPECT_EQ(window.firstIndex, 2u);  // Summarized messages are not sent again
+
+    nlohmann::json messages = builder.buildMessages(history, window, "Be brief.");
+    ASSERT_EQ(messages.size(), 3u);
+    EXPECT_EQ(messages[0]["role"], "system");
+    EXPECT_EQ(messages[0]["content"], "Be brief.");
+    EXPECT_EQ(messages[1]["role"], "system");
+    EXPECT_NE(messages[1]["content"].get<std::string>().find("They greeted each other."), std::string::npos);
+    EXPECT_EQ(messages[2]["content"], "how are you?");
+
+    std::string prompt = builder.buildPrompt(history, window);
+    EXPECT_EQ(prompt.rfind("Summary of earlier conversation:", 0), 0u);
+    EXPECT_EQ(prompt.substr(prompt.size() - 12), "how are you?");
+}
+
+TEST(ContextBuilderTest, CurrentMessageIsKeptEvenIfItExceedsTheBudget) {
+    ConversationHistory history;
+    addMessages(history, 3);
+    history.addUserMessage(QString(400, QChar('y')));  // ~100 tokens
+
+    ContextBuilder builder;
+    builder.setTokenBudget(50);
+    ContextWindow window = builder.select(history, "");
+
+    EXPECT_EQ(window.firstIndex, 3u);
+    EXPECT_EQ(window.messagesIncluded, 1u);
+    EXPECT_GT(window.estimatedTokens, builder.tokenBudget());
+    EXPECT_EQ(builder.buildPrompt(history, window), std::string(400, 'y'));
+}
+
+} // namespace
+} // namespace Chatbot
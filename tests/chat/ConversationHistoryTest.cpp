@@ -0,0 +1,118 @@
+#include "chat/ConversationHistory.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace Chatbot {
+namespace {
+
+// Add "m1".."mN" as alternating user and bot messages
+void addMessages(ConversationHistory& history, int first, int last) {
+    for (int i = first; i <= last; ++i) {
+        QString text = QString("m%1").arg(i);
+        if (i % 2 == 1) {
+            history.addUserMessage(text);
+        } else {
+            history.addBotMessage(text);
+        }
+    }
+}
+
+std::vector<std::string> contents(const ConversationHistory& history) {
+    std::vector<std::string> result;
+    for (const Message& message : history) {
+        result.push_back(message.content);
+    }
+    return result;
+}
+
+using Contents = std::vector<std::string>;
+
+TEST(ConversationHistoryTest, FullHistoryOverwritesTheOldestMessage) {
+    ConversationHistory history;
+    history.setMaxMessages(3);
+    addMessages(history, 1, 5);
+
+    EXPECT_EQ(history.messageCount(), 3u);
+    EXPECT_EQ(contents(history), (Contents{"m3", "m4", "m5"}));
+    EXPECT_EQ(history.at(0).sequence, 3u);
+    EXPECT_EQ(history.back().content, "m5");
+    EXPECT_EQ(history.back().role, "user");
+}
+
+TEST(ConversationHistoryTest, IteratorsRunOldestFirstAfterTheHeadWraps) {
+    ConversationHistory history;
+    history.setMaxMessages(4);
+    addMessages(history, 1, 11);  // Head has gone round the ring twice
+
+    auto first = history.begin();
+    ASSERT_EQ(history.end() - first, 4);
+    EXPECT_EQ(first->content, "m8");
+    EXPECT_EQ(first[3].content, "m11");
+    EXPECT_EQ((history.end() - 1)->content, "m11");
+
+    quint64 previous = 0;
+    for (auto it = history.begin(); it != history.end(); ++it) {
+        EXPECT_GT(it->sequence, previous);
+        previous = it->sequence;
+    }
+
+    auto recent = history.getRecentMessages(2);
+    ASSERT_EQ(recent.size(), 2u);
+    EXPECT_EQ(recent.begin()->content, "m10");
+    EXPECT_EQ(history.getRecentMessages(10).size(), 4u);
+}
+
+TEST(ConversationHistoryTest, ShrinkingKeepsTheNewestMessagesInOrder) {
+    ConversationHistory history;
+    history.setMaxMessages(4);
+    addMessages(history, 1, 6);
+
+    history.setMaxMessages(2);
+    EXPECT_EQ(contents(history), (Contents{"m5", "m6"}));
+
+    // The ring carries on from the shrunk state
+    addMessages(history, 7, 9);
+    EXPECT_EQ(contents(history), (Contents{"m8", "m9"}));
+}
+
+TEST(ConversationHistoryTest, GrowingAfterAWrapAppendsInOrder) {
+    ConversationHistory history;
+    history.setMaxMessages(3);
+    addMessages(history, 1, 4);
+
+    history.setMaxMessages(5);
+    addMessages(history, 5, 7);
+    EXPECT_EQ(contents(history), (Contents{"m3", "m4", "m5", "m6", "m7"}));
+}
+
+TEST(ConversationHistoryTest, ZeroMeansUnlimited) {
+    ConversationHistory history;
+    history.setMaxMessages(0);
+    addMessages(history, 1, 150);
+
+    EXPECT_EQ(history.messageCount(), 150u);
+    EXPECT_EQ(history.begin()->content, "m1");
+}
+
+TEST(ConversationHistoryTest, SummaryCoversMessagesThroughASequenceNumber) {
+    ConversationHistory history;
+    addMessages(history, 1, 4);
+    EXPECT_FALSE(history.hasSummary());
+    EXPECT_EQ(history.summarizedThrough(), 0u);
+
+    history.setSummary("The user said hello.", history.at(1).sequence);
+    ASSERT_TRUE(history.hasSummary());
+    EXPECT_EQ(history.summary().role, "system");
+    EXPECT_EQ(history.summary().content, "The user said hello.");
+    EXPECT_EQ(history.summarizedThrough(), 2u);
+    EXPECT_EQ(history.messageCount(), 4u);  // The summarized messages stay
+
+    history.clear();
+    EXPECT_TRUE(history.isEmpty());
+    EXPECT_FALSE(history.hasSummary());
+    EXPECT_EQ(history.summarizedThrough(), 0u);
+}
+
+} // namespace
+} // namespace Chatbot
@@ -0,0 +1,134 @@
+#include "chat/RequestScheduler.h"
+#include <QTest>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Chatbot {
+namespace {
+
+constexpr int kTimeoutMs = 5000;
+
+// Runs one request at a time and records the order in which jobs ran
+class RequestSchedulerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_scheduler.setMaxInFlight(1);
+        m_scheduler.setMaxQueuedPerSession(4);
+    }
+
+    bool submit(const QString& sessionId, const QString& name,
+                RequestPriority priority = RequestPriority::Interactive,
+                CancellationToken token = CancellationToken()) {
+        return m_scheduler.submit(sessionId, priority, token,
+            [this, name]() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_ran.push_back(name);
+                return name;
+            },
+            [this](const QString& result) {
+                m_results.push_back(result);
+            });
+    }
+
+    bool waitForResults(size_t count) {
+        return QTest::qWaitFor([&]() { return m_results.size() >= count; }, kTimeoutMs);
+    }
+
+    std::vector<QString> ran() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_ran;
+    }
+
+    RequestScheduler m_scheduler;
+    std::mutex m_mutex;
+    std::vector<QString> m_ran;
+    std::vector<QString> m_results;  // Completions, on the test thread
+};
+
+TEST_F(RequestSchedulerTest, SessionsTakeTurns) {
+    // a1 starts at once; the rest wait for it (completions need the event loop)
+    ASSERT_TRUE(submit("a", "a1"));
+    ASSERT_TRUE(submit("a", "a2"));
+    ASSERT_TRUE(submit("a", "a3"));
+    ASSERT_TRUE(submit("a", "a4"));
+    ASSERT_TRUE(submit("b", "b1"));
+    ASSERT_TRUE(submit("b", "b2"));
+
+    ASSERT_TRUE(waitForResults(6));
+    EXPECT_EQ(ran(), (std::vector<QString>{"a1", "a2", "b1", "a3", "b2", "a4"}));
+}
+
+TEST_F(RequestSchedulerTest, InteractiveRequestsRunBeforeBackgroundWork) {
+    ASSERT_TRUE(submit("a", "reply1"));
+    ASSERT_TRUE(submit("a", "summary", RequestPriority::Background));
+    ASSERT_TRUE(submit("b", "reply2"));
+    ASSERT_TRUE(submit("b", "reply3"));
+
+    ASSERT_TRUE(waitForResults(4));
+    EXPECT_EQ(ran(), (std::vector<QString>{"reply1", "reply2", "reply3", "summary"}));
+}
+
+TEST_F(RequestSchedulerTest, FullSessionQueuesAreRefused) {
+    m_scheduler.setMaxQueuedPerSession(2);
+    ASSERT_TRUE(submit("a", "running"));
+    ASSERT_TRUE(submit("a", "queued1"));
+    ASSERT_TRUE(submit("a", "queued2"));
+
+    EXPECT_FALSE(m_scheduler.canAccept("a"));
+    EXPECT_FALSE(submit("a", "refused"));
+    EXPECT_EQ(m_scheduler.stats().queued, 2);
+
+    // Other sessions and the background queue have their own limits
+    EXPECT_TRUE(m_scheduler.canAccept("b"));
+    EXPECT_TRUE(m_scheduler.canAccept("a", RequestPriority::Background));
+
+    ASSERT_TRUE(waitForResults(3));
+    EXPECT_EQ(m_results.size(), 3u);  // No completion for the refused request
+    EXPECT_TRUE(m_scheduler.canAccept("a"));
+}
+
+TEST_F(RequestSchedulerTest, CancelledRequestsFreeTheirQueueSlotAndDoNotRun) {
+    m_scheduler.setMaxQueuedPerSession(2);
+    CancellationToken token;
+    ASSERT_TRUE(submit("a", "running"));
+    ASSERT_TRUE(submit("a", "cancelled", RequestPriority::Interactive, token));
+    ASSERT_TRUE(submit("a", "queued"));
+    EXPECT_FALSE(m_scheduler.canAccept("a"));
+
+    token.cancel();
+    EXPECT_TRUE(m_scheduler.canAccept("a"));
+    SchedulerStats stats = m_scheduler.stats();
+    EXPECT_EQ(stats.queued, 1);
+    EXPECT_EQ(stats.sessionsWaiting, 1);
+
+    ASSERT_TRUE(waitForResults(3));
+    EXPECT_EQ(ran(), (std::vector<QString>{"running", "queued"}));
+    // The cancelled request still completes, with an empty result
+    EXPECT_EQ(std::count(m_results.begin(), m_results.end(), QString()), 1);
+}
+
+TEST_F(RequestSchedulerTest, WaitForRunningJobsBlocksUntilJobsReturn) {
+    std::atomic<bool> returned{false};
+    bool completed = false;
+    m_scheduler.submit("a", RequestPriority::Interactive, CancellationToken(),
+        [&returned]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            returned = true;
+            return QString("done");
+        },
+        [&completed](const QString&) { completed = true; });
+
+    m_scheduler.waitForRunningJobs();
+    EXPECT_TRUE(returned);
+    EXPECT_FALSE(completed);  // Completions still go through the event loop
+
+    EXPECT_TRUE(QTest::qWaitFor([&]() { return completed; }, kTimeoutMs));
+}
+
+} // namespace
+} // namespace Chatbot
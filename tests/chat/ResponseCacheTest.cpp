@@ -0,0 +1,85 @@
+#include "chat/ResponseCache.h"
+#include <QFile>
+#include <QTemporaryDir>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+
+namespace Chatbot {
+namespace {
+
+void writeFile(const QString& path, const QByteArray& data) {
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(data);
+}
+
+TEST(ResponseCacheTest, PersistedEntriesSurviveARestart) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString path = dir.filePath("responses.json");
+
+    {
+        ResponseCache cache;
+        cache.setPersistPath(path);
+        cache.insert("key", "reply");
+    }
+
+    ResponseCache cache;
+    cache.setPersistPath(path);
+    EXPECT_EQ(cache.lookup("key").value_or(""), "reply");
+}
+
+TEST(ResponseCacheTest, LeastRecentlyUsedEntriesAreEvictedBeyondTheByteBudget) {
+    ResponseCache cache;
+    cache.setMaxBytes(30);
+    cache.insert("a", std::string(10, 'a'));  // 11 bytes with the key
+    cache.insert("b", std::string(10, 'b'));
+    ASSERT_TRUE(cache.lookup("a").has_value());  // Now more recent than "b"
+
+    cache.insert("c", std::string(10, 'c'));
+    EXPECT_FALSE(cache.lookup("b").has_value());
+    EXPECT_TRUE(cache.lookup("a").has_value());
+    EXPECT_TRUE(cache.lookup("c").has_value());
+    EXPECT_EQ(cache.stats().bytes, 22u);
+    EXPECT_EQ(cache.stats().evicted, 1u);
+
+    // A reply larger than the whole budget is not cached and evicts nothing
+    cache.insert("d", std::string(40, 'd'));
+    EXPECT_FALSE(cache.lookup("d").has_value());
+    EXPECT_EQ(cache.stats().entries, 2u);
+}
+
+TEST(ResponseCacheTest, MistypedEntriesAreSkippedOnLoad) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString path = dir.filePath("responses.json");
+
+    auto now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    QByteArray created = QByteArray::number(static_cast<qint64>(now));
+    writeFile(path, "[{\"key\": 42, \"reply\": \"a\", \"created\": " + created + "},"
+                    " {\"key\": \"b\", \"reply\": [\"b\"], \"created\": " + created + "},"
+                    " {\"key\": \"c\", \"reply\": \"c\", \"created\": \"yesterday\"},"
+                    " \"not an object\","
+                    " {\"key\": \"ok\", \"reply\": \"fine\", \"created\": " + created + "}]");
+
+    ResponseCache cache;
+    ASSERT_NO_THROW(cache.setPersistPath(path));
+    EXPECT_EQ(cache.stats().entries, 1u);
+    EXPECT_EQ(cache.lookup("ok").value_or(""), "fine");
+}
+
+TEST(ResponseCacheTest, MalformedFileIsIgnored) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString path = dir.filePath("responses.json");
+    writeFile(path, "{ not json");
+
+    ResponseCache cache;
+    ASSERT_NO_THROW(cache.setPersistPath(path));
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+} // namespace
+} // namespace Chatbot
@@ -0,0 +1,107 @@
+#include "emotion/KeywordAutomaton.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace Chatbot {
+namespace {
+
+enum Category { Happy, Sad, Thoughtful, CategoryCount };
+
+class KeywordAutomatonTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_automaton.addKeyword("good", Happy);
+        m_automaton.addKeyword("enjoy*", Happy);
+        m_automaton.addKeyword("can't wait", Happy);
+        m_automaton.addKeyword("hard", Sad);
+        m_automaton.addKeyword("let me", Thoughtful);
+        m_automaton.build();
+    }
+
+    std::vector<int> count(const QString& text) const {
+        std::vector<int> counts(CategoryCount, 0);
+        m_automaton.count(text, counts.data());
+        return counts;
+    }
+
+    // Same text, scanned in pieces of the given sizes
+    std::vector<int> countInPieces(const QString& text, const std::vector<int>& sizes) const {
+        std::vector<int> counts(CategoryCount, 0);
+        KeywordAutomaton::ScanState state;
+        qsizetype position = 0;
+        for (int size : sizes) {
+            m_automaton.scan(text.mid(position, size), state, counts.data());
+            position += size;
+        }
+        m_automaton.scan(text.mid(position), state, counts.data());
+        m_automaton.finish(state, counts.data());
+        return counts;
+    }
+
+    KeywordAutomaton m_automaton;
+};
+
+TEST_F(KeywordAutomatonTest, MatchesWholeWordsOnly) {
+    EXPECT_EQ(count("good")[Happy], 1);
+    EXPECT_EQ(count("Goodbye, and good luck.")[Happy], 1);
+    EXPECT_EQ(count("hardware is hard")[Sad], 1);
+    EXPECT_EQ(count("goodness, hardly")[Happy] + count("goodness, hardly")[Sad], 0);
+}
+
+TEST_F(KeywordAutomatonTest, IsCaseInsensitive) {
+    EXPECT_EQ(count("GOOD Good good")[Happy], 3);
+}
+
+TEST_F(KeywordAutomatonTest, StarKeywordMatchesLongerWords) {
+    std::vector<int> counts = count("enjoy, enjoyed, enjoying; overenjoy");
+    EXPECT_EQ(counts[Happy], 3);
+}
+
+TEST_F(KeywordAutomatonTest, MultiWordKeywordAcrossPunctuationRuns) {
+    EXPECT_EQ(count("Hmm, let me see.")[Thoughtful], 1);
+    EXPECT_EQ(count("let  \n me")[Thoughtful], 1);
+    EXPECT_EQ(count("outlet me")[Thoughtful], 0);
+}
+
+TEST_F(KeywordAutomatonTest, NormalizesCurlyApostrophes) {
+    EXPECT_EQ(count("I can’t wait")[Happy], 1);
+    EXPECT_EQ(count("I can‘t wait")[Happy], 1);
+    EXPECT_EQ(count("I can't wait")[Happy], 1);
+}
+
+TEST_F(KeywordAutomatonTest, KeywordSpanningPiecesStillMatches) {
+    const QString text = "it was good, then hard";
+    std::vector<int> whole = count(text);
+
+    // Split inside "good", right after it, and inside "hard"
+    EXPECT_EQ(countInPieces(text, {9}), whole);
+    EXPECT_EQ(countInPieces(text, {11}), whole);
+    EXPECT_EQ(countInPieces(text, {19, 1, 1}), whole);
+    EXPECT_EQ(whole[Happy], 1);
+    EXPECT_EQ(whole[Sad], 1);
+}
+
+TEST_F(KeywordAutomatonTest, PiecesDoNotJoinAcrossAMissingBoundary) {
+    // "good" followed by "bye" in the next piece is still "goodbye"
+    EXPECT_EQ(countInPieces("goodbye", {4})[Happy], 0);
+}
+
+TEST_F(KeywordAutomatonTest, FinishCompletesAKeywordAtTheEnd) {
+    std::vector<int> counts(CategoryCount, 0);
+    KeywordAutomaton::ScanState state;
+    m_automaton.scan("that is good", state, counts.data());
+    EXPECT_EQ(counts[Happy], 0);  // Could still become "goodbye"
+    m_automaton.finish(state, counts.data());
+    EXPECT_EQ(counts[Happy], 1);
+}
+
+TEST_F(KeywordAutomatonTest, UnbuiltAutomatonCountsNothing) {
+    KeywordAutomaton automaton;
+    automaton.addKeyword("good", Happy);
+    std::vector<int> counts(CategoryCount, 0);
+    automaton.count("good", counts.data());
+    EXPECT_EQ(counts[Happy], 0);
+}
+
+} // namespace
+} // namespace Chatbot
@@ -0,0 +1,137 @@
+#include "server/HeadlessServer.h"
+#include <QLocalSocket>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtEndian>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <optional>
+
+namespace Chatbot {
+namespace {
+
+using json = nlohmann::json;
+
+constexpr int kTimeoutMs = 5000;
+
+// Client side of the framing protocol; only JSON frames are read back
+class FrameClient {
+public:
+    bool connectTo(const QString& name) {
+        m_socket.connectToServer(name);
+        return QTest::qWaitFor([this]() { return m_socket.state() == QLocalSocket::ConnectedState; },
+                               kTimeoutMs);
+    }
+
+    void sendRaw(const QByteArray& bytes) {
+        m_socket.write(bytes);
+        m_socket.flush();
+    }
+
+    static QByteArray frame(const QByteArray& payload, char type = 'J') {
+        char header[5];
+        qToBigEndian<quint32>(static_cast<quint32>(payload.size() + 1), header);
+        header[4] = type;
+        return QByteArray(header, sizeof(header)) + payload;
+    }
+
+    void send(const QByteArray& payload) { sendRaw(frame(payload)); }
+
+    // Next JSON event from the server, or nullopt on timeout
+    std::optional<json> nextEvent() {
+        std::optional<json> event;
+        QTest::qWaitFor([this, &event]() {
+            m_buffer += m_socket.readAll();
+            while (m_buffer.size() >= 5) {
+                quint32 length = qFromBigEndian<quint32>(m_buffer.constData());
+                if (static_cast<quint32>(m_buffer.size()) < 4 + length) {
+                    return false;
+                }
+                char type = m_buffer.at(4);
+                QByteArray payload = m_buffer.mid(5, static_cast<int>(length) - 1);
+                m_buffer.remove(0, 4 + static_cast<int>(length));
+                if (type == 'J') {
+                    event = json::parse(payload.toStdString());
+                    return true;
+                }
+            }
+            return false;
+        }, kTimeoutMs);
+        return event;
+    }
+
+    bool waitForDisconnect() {
+        return QTest::qWaitFor([this]() { return m_socket.state() == QLocalSocket::UnconnectedState; },
+                               kTimeoutMs);
+    }
+
+private:
+    QLocalSocket m_socket;
+    QByteArray m_buffer;
+};
+
+class HeadlessServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        m_name = m_dir.filePath("chatbot.sock");
+        ASSERT_TRUE(m_server.listen(m_name));
+    }
+
+    // Connect and consume the "ready" event
+    void connectClient(FrameClient& client) {
+        ASSERT_TRUE(client.connectTo(m_name));
+        std::optional<json> ready = client.nextEvent();
+        ASSERT_TRUE(ready.has_value());
+        EXPECT_EQ((*ready)["event"], "ready");
+    }
+
+    static void expectError(FrameClient& client, const std::string& message) {
+        std::optional<json> event = client.nextEvent();
+        ASSERT_TRUE(event.has_value());
+        EXPECT_EQ((*event)["event"], "error");
+        EXPECT_EQ((*event)["message"], message);
+    }
+
+    QTemporaryDir m_dir;
+    QString m_name;
+    HeadlessServer m_server;
+};
+
+TEST_F(HeadlessServerTest, MistypedFieldsAreAnsweredAsMalformed) {
+    FrameClient client;
+    connectClient(client);
+
+    client.send(R"({"type": 5})");
+    expectError(client, "Malformed request");
+    client.send(R"({"type": "message", "text": 42})");
+    expectError(client, "Malformed request");
+    client.send(R"({"type": "personality", "name": ["Friendly"]})");
+    expectError(client, "Malformed request");
+    client.send(R"(["not", "an", "object"])");
+    expectError(client, "Malformed request");
+
+    // The connection is still served
+    client.send(R"({"type": "unknown"})");
+    expectError(client, "Unknown request type");
+}
+
+TEST_F(HeadlessServerTest, InvalidFrameDisconnectsOnlyThatClient) {
+    FrameClient bad;
+    connectClient(bad);
+    FrameClient good;
+    connectClient(good);
+
+    // A request and an invalid (empty) frame in one read
+    bad.sendRaw(FrameClient::frame(R"({"type": "unknown"})") + QByteArray(4, '\0'));
+    ASSERT_TRUE(bad.waitForDisconnect());
+
+    good.send(R"({"type": "unknown"})");
+    expectError(good, "Unknown request type");
+
+    FrameClient next;
+    connectClient(next);
+}
+
+} // namespace
+} // namespace Chatbot
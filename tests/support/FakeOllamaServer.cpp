@@ -0,0 +1,180 @@
+#include "support/FakeOllamaServer.h"
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <algorithm>
+
+using json = nlohmann::json;
+
+namespace Chatbot {
+
+namespace {
+int estimateTokens(size_t chars) {
+    return static_cast<int>((chars + 3) / 4);  // ~4 characters per token
+}
+}
+
+FakeOllamaServer::FakeOllamaServer(QObject *parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_chunks({"Hello", " there", "!"})
+    , m_truncate(false)
+    , m_evalDelayMs(0.0)
+{
+    connect(m_server, &QTcpServer::newConnection, this, &FakeOllamaServer::onNewConnection);
+}
+
+FakeOllamaServer::~FakeOllamaServer() {
+    m_server->close();
+}
+
+bool FakeOllamaServer::start() {
+    return m_server->listen(QHostAddress::LocalHost, 0);
+}
+
+QString FakeOllamaServer::url() const {
+    return QString("http://127.0.0.1:%1").arg(m_server->serverPort());
+}
+
+void FakeOllamaServer::onNewConnection() {
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        m_connections.insert(socket, Connection{});
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            onReadyRead(socket);
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_connections.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void FakeOllamaServer::onReadyRead(QTcpSocket* socket) {
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end()) {
+        return;
+    }
+    Connection& connection = *it;
+    connection.buffer += socket->readAll();
+
+    qsizetype headerEnd = connection.buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return;
+    }
+
+    QList<QByteArray> lines = connection.buffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    qsizetype contentLength = 0;
+    bool expectsContinue = false;
+    for (const QByteArray& line : lines) {
+        QByteArray lower = line.trimmed().toLower();
+        if (lower.startsWith("content-length:")) {
+            contentLength = lower.mid(15).trimmed().toLongLong();
+        } else if (lower.startsWith("expect:") && lower.contains("100-continue")) {
+            expectsContinue = true;
+        }
+    }
+
+    qsizetype bodyStart = headerEnd + 4;
+    if (connection.buffer.size() - bodyStart < contentLength) {
+        if (expectsContinue && !connection.continueSent) {
+            socket->write("HTTP/1.1 100 Continue\r\n\r\n");
+            connection.continueSent = true;
+        }
+        return;
+    }
+
+    std::string path = requestLine.value(1).toStdString();
+    std::string body = connection.buffer.mid(bodyStart, contentLength).toStdString();
+    connection.buffer.clear();
+    respond(socket, path, body);
+}
+
+void FakeOllamaServer::respond(QTcpSocket* socket, const std::string& path, const std::string& body) {
+    FakeOllamaRequest request;
+    request.path = path;
+    request.body = json::parse(body, nullptr, false);
+
+    // Only what differs from the previous prompt needs evaluating
+    std::string prompt = promptText(request.body);
+    auto mismatch = std::mismatch(prompt.begin(), prompt.end(), m_previousPrompt.begin(), m_previousPrompt.end());
+    size_t reused = static_cast<size_t>(mismatch.first - prompt.begin());
+    request.promptTokens = estimateTokens(prompt.size());
+    request.evaluated = estimateTokens(prompt.size() - reused);
+    if (!prompt.empty()) {
+        m_previousPrompt = prompt;  // A model load (empty prompt) leaves the cache alone
+    }
+
+    bool stream = request.body.is_object() && request.body.value("stream", true);
+    int evaluated = request.evaluated;
+    m_requests.push_back(std::move(request));
+
+    int delayMs = static_cast<int>(evaluated * m_evalDelayMs);
+    QTimer::singleShot(delayMs, socket, [this, socket, path, stream, evaluated]() {
+        sendReply(socket, path, stream, evaluated);
+    });
+}
+
+void FakeOllamaServer::sendReply(QTcpSocket* socket, const std::string& path, bool stream, int evaluated) {
+    bool chat = path == "/api/chat";
+    auto chunk = [chat](const std::string& text, bool done) {
+        json object = {{"model", "fake"}, {"done", done}};
+        if (chat) {
+            object["message"] = {{"role", "assistant"}, {"content", text}};
+        } else {
+            object["response"] = text;
+        }
+        return object;
+    };
+
+    // No Content-Length: the body ends when the connection closes
+    std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/x-ndjson\r\nConnection: close\r\n\r\n";
+
+    if (!m_error.empty()) {
+        response += json{{"error", m_error}}.dump() + "\n";
+    } else if (stream) {
+        for (const std::string& text : m_chunks) {
+            response += chunk(text, false).dump() + "\n";
+        }
+        if (!m_truncate) {
+            json last = chunk("", true);
+            last["done_reason"] = "stop";
+            last["prompt_eval_count"] = evaluated;
+            last["prompt_eval_duration"] = static_cast<int64_t>(evaluated * m_evalDelayMs * 1e6);
+            response += last.dump() + "\n";
+        }
+    } else {
+        std::string text;
+        for (const std::string& part : m_chunks) {
+            text += part;
+        }
+        json reply = chunk(text, true);
+        reply["prompt_eval_count"] = evaluated;
+        response += reply.dump();
+    }
+
+    socket->write(response.data(), static_cast<qint64>(response.size()));
+    socket->disconnectFromHost();
+}
+
+std::string FakeOllamaServer::promptText(const json& body) {
+    if (!body.is_object()) {
+        return {};
+    }
+
+    std::string text;
+    if (body.contains("messages") && body["messages"].is_array()) {
+        for (const json& message : body["messages"]) {
+            text += message.value("role", "") + ": " + message.value("content", "") + "\n";
+        }
+    } else {
+        std::string prompt = body.value("prompt", "");
+        if (!prompt.empty()) {
+            text = body.value("system", "") + "\n" + prompt;
+        }
+    }
+    return text;
+}
+
+} // namespace Chatbot
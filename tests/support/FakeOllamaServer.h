@@ -0,0 +1,93 @@
+#ifndef CHATBOT_FAKEOLLAMASERVER_H
+#define CHATBOT_FAKEOLLAMASERVER_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+class QTcpServer;
+class QTcpSocket;
+
+namespace Chatbot {
+
+// One request as received by the fake server
+struct FakeOllamaRequest {
+    std::string path;      // "/api/chat" or "/api/generate"
+    nlohmann::json body;
+    int promptTokens = 0;  // Estimated prompt size
+    int evaluated = 0;     // Tokens reported in prompt_eval_count
+};
+
+/**
+ * FakeOllamaServer answers Ollama's /api/chat and /api/generate on a local
+ * port with a scripted reply, streamed as NDJSON (one chunk per entry of
+ * the script) or as a single JSON object for "stream": false.
+ *
+ * Like Ollama's KV cache, it only "evaluates" the part of a prompt that
+ * differs from the previous request's prompt, reports that count in
+ * prompt_eval_count and delays the reply by it (see setEvalDelayPerToken).
+ *
+ * Runs on the thread that created it; the code under test must make its
+ * requests from other threads (ChatEngine always does).
+ */
+class FakeOllamaServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FakeOllamaServer(QObject *parent = nullptr);
+    ~FakeOllamaServer() override;
+
+    // Delete copy constructor and assignment operator
+    FakeOllamaServer(const FakeOllamaServer&) = delete;
+    FakeOllamaServer& operator=(const FakeOllamaServer&) = delete;
+
+    bool start();      // Listens on a free port on 127.0.0.1
+    QString url() const;
+
+    // Reply text, split into one stream chunk per entry
+    void setReply(const std::vector<std::string>& chunks) { m_chunks = chunks; }
+
+    // Close the connection after the chunks without sending the final
+    // "done" chunk (a generation cut off midway)
+    void setTruncateStream(bool truncate) { m_truncate = truncate; }
+
+    // Send {"error": ...} instead of a reply
+    void setError(const std::string& error) { m_error = error; }
+
+    void setEvalDelayPerToken(double milliseconds) { m_evalDelayMs = milliseconds; }
+
+    const std::vector<FakeOllamaRequest>& requests() const { return m_requests; }
+
+private slots:
+    void onNewConnection();
+
+private:
+    struct Connection {
+        QByteArray buffer;
+        bool continueSent = false;  // "100 Continue" for curl's Expect header
+    };
+
+    void onReadyRead(QTcpSocket* socket);
+    void respond(QTcpSocket* socket, const std::string& path, const std::string& body);
+    void sendReply(QTcpSocket* socket, const std::string& path, bool stream, int evaluated);
+
+    // The prompt as a model would see it, for the prefix comparison
+    static std::string promptText(const nlohmann::json& body);
+
+private:
+    QTcpServer* m_server;
+    QHash<QTcpSocket*, Connection> m_connections;
+    std::vector<std::string> m_chunks;
+    bool m_truncate;
+    std::string m_error;
+    double m_evalDelayMs;
+    std::string m_previousPrompt;
+    std::vector<FakeOllamaRequest> m_requests;
+};
+
+} // namespace Chatbot
+
+#endif // CHATBOT_FAKEOLLAMASERVER_H
@@ -0,0 +1,11 @@
+#include <QCoreApplication>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+// Qt objects under test need an application (event loop, thread pool)
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    spdlog::set_level(spdlog::level::warn);
+    return RUN_ALL_TESTS();
+}
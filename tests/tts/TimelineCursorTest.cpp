@@ -0,0 +1,99 @@
+#include "tts/TimelineCursor.h"
+#include <gtest/gtest.h>
+
+namespace Chatbot {
+namespace {
+
+// Ten back-to-back 100 ms phonemes: [0.0, 0.1), [0.1, 0.2), ... [0.9, 1.0)
+TimelineCursor contiguousCursor() {
+    TimelineCursor cursor;
+    for (int i = 0; i < 10; ++i) {
+        cursor.append(i * 0.1, (i + 1) * 0.1);
+    }
+    return cursor;
+}
+
+TEST(TimelineCursorTest, EmptyCursorFindsNothing) {
+    TimelineCursor cursor;
+    EXPECT_EQ(cursor.seek(0.5), -1);
+    EXPECT_EQ(cursor.currentIndex(), -1);
+}
+
+TEST(TimelineCursorTest, StepsForwardFrameByFrame) {
+    TimelineCursor cursor = contiguousCursor();
+
+    // ~60 fps ticks cross every boundary once
+    int expected = 0;
+    for (double time = 0.005; time < 1.0; time += 0.016) {
+        while ((expected + 1) * 0.1 <= time) {
+            ++expected;
+        }
+        ASSERT_EQ(cursor.seek(time), expected) << "at " << time;
+    }
+}
+
+TEST(TimelineCursorTest, JumpsForwardBeyondTheLinearSteps) {
+    TimelineCursor cursor = contiguousCursor();
+    EXPECT_EQ(cursor.seek(0.05), 0);
+    EXPECT_EQ(cursor.seek(0.95), 9);
+    EXPECT_EQ(cursor.currentIndex(), 9);
+}
+
+TEST(TimelineCursorTest, SeeksBackward) {
+    TimelineCursor cursor = contiguousCursor();
+    EXPECT_EQ(cursor.seek(0.95), 9);
+    EXPECT_EQ(cursor.seek(0.25), 2);
+    EXPECT_EQ(cursor.seek(0.15), 1);
+
+    // ...and resumes stepping forward from there
+    EXPECT_EQ(cursor.seek(0.35), 3);
+}
+
+TEST(TimelineCursorTest, GapsAndTimesOutsideTheTimelineFindNothing) {
+    TimelineCursor cursor;
+    cursor.append(0.1, 0.2);
+    cursor.append(0.4, 0.5);
+
+    EXPECT_EQ(cursor.seek(0.05), -1);  // Before the first phoneme
+    EXPECT_EQ(cursor.seek(0.15), 0);
+    EXPECT_EQ(cursor.seek(0.3), -1);   // Between the two
+    EXPECT_EQ(cursor.seek(0.45), 1);
+    EXPECT_EQ(cursor.seek(0.6), -1);   // After the last
+    EXPECT_EQ(cursor.seek(0.15), 0);
+}
+
+TEST(TimelineCursorTest, AppendsPhonemesAtAnOffset) {
+    TimelineCursor cursor;
+    cursor.append({{"h", 1, 0.0, 0.1}, {"a", 2, 0.1, 0.2}});
+    cursor.append({{"i", 3, 0.0, 0.1}}, 0.5);
+
+    ASSERT_EQ(cursor.size(), 3u);
+    EXPECT_FLOAT_EQ(cursor.startTime(2), 0.5f);
+    EXPECT_FLOAT_EQ(cursor.endTime(2), 0.6f);
+    EXPECT_EQ(cursor.seek(0.35), -1);
+    EXPECT_EQ(cursor.seek(0.55), 2);
+}
+
+TEST(TimelineCursorTest, ExtendLastCoversTheFollowingTime) {
+    TimelineCursor cursor;
+    cursor.append(0.0, 0.1);
+    EXPECT_EQ(cursor.seek(0.15), -1);
+
+    cursor.extendLast(0.2);
+    EXPECT_EQ(cursor.seek(0.15), 0);
+}
+
+TEST(TimelineCursorTest, ClearResetsThePosition) {
+    TimelineCursor cursor = contiguousCursor();
+    EXPECT_EQ(cursor.seek(0.95), 9);
+
+    cursor.clear();
+    EXPECT_TRUE(cursor.isEmpty());
+    EXPECT_EQ(cursor.currentIndex(), -1);
+
+    cursor.append(0.0, 0.1);
+    EXPECT_EQ(cursor.seek(0.05), 0);
+}
+
+} // namespace
+} // namespace Chatbot
@@ -0,0 +1,142 @@
+#include "tts/TtsCache.h"
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <gtest/gtest.h>
+#include <utility>
+
+namespace Chatbot {
+namespace {
+
+CachedUtterance utterance(const QString& text) {
+    CachedUtterance result;
+    result.pcm = QByteArray(4000, '\x7f');
+    result.sampleRate = 22050;
+    result.timeline.text = text;
+    result.timeline.totalDuration = 0.25;
+    result.timeline.phonemes = {{"h", 20, 0.0, 0.05}, {"ə", 59, 0.05, 0.1}, {"l", 24, 0.15, 0.1}};
+    return result;
+}
+
+class TtsCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+    }
+
+    QString entryPath(const QString& key) const {
+        return m_dir.path() + "/" + key + ".utt";
+    }
+
+    // Size of one entry on disk (all test utterances have the same size)
+    qint64 entryBytes() {
+        QTemporaryDir dir;
+        TtsCache cache(dir.path());
+        cache.insert("probe", utterance("a"));
+        return cache.stats().bytes;
+    }
+
+    QTemporaryDir m_dir;
+};
+
+TEST_F(TtsCacheTest, StoredUtterancesRoundTripAcrossRestarts) {
+    CachedUtterance stored = utterance("hello");
+    {
+        TtsCache cache(m_dir.path());
+        cache.insert("key", stored);
+        EXPECT_TRUE(cache.contains("key"));
+    }
+
+    TtsCache cache(m_dir.path());
+    std::optional<CachedUtterance> loaded = cache.lookup("key");
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_TRUE(loaded->mapping);
+    EXPECT_EQ(loaded->pcm, stored.pcm);
+    EXPECT_EQ(loaded->sampleRate, 22050);
+    EXPECT_EQ(loaded->timeline.text, "hello");
+    EXPECT_DOUBLE_EQ(loaded->timeline.totalDuration, 0.25);
+    ASSERT_EQ(loaded->timeline.phonemes.size(), 3u);
+    EXPECT_EQ(loaded->timeline.phonemes[1].symbol, "ə");
+    EXPECT_EQ(loaded->timeline.phonemes[1].id, 59);
+    EXPECT_DOUBLE_EQ(loaded->timeline.phonemes[2].startTime, 0.15);
+    EXPECT_DOUBLE_EQ(loaded->timeline.phonemes[2].duration, 0.1);
+
+    EXPECT_FALSE(cache.lookup("other").has_value());
+    EXPECT_EQ(cache.stats().hits, 1u);
+    EXPECT_EQ(cache.stats().misses, 1u);
+}
+
+TEST_F(TtsCacheTest, LeastRecentlyUsedEntriesAreEvictedBeyondTheBudget) {
+    qint64 bytes = entryBytes();
+    TtsCache cache(m_dir.path(), bytes * 2 + bytes / 2);
+    cache.insert("a", utterance("a"));
+    cache.insert("b", utterance("b"));
+    ASSERT_TRUE(cache.lookup("a").has_value());  // Now more recent than "b"
+
+    cache.insert("c", utterance("c"));
+    EXPECT_TRUE(cache.contains("a"));
+    EXPECT_FALSE(cache.contains("b"));
+    EXPECT_TRUE(cache.contains("c"));
+    EXPECT_FALSE(QFile::exists(entryPath("b")));
+    EXPECT_EQ(cache.stats().bytes, bytes * 2);
+
+    // An utterance larger than the whole budget is not stored
+    cache.setByteBudget(bytes - 1);
+    EXPECT_EQ(cache.stats().entries, 0u);
+    cache.insert("d", utterance("d"));
+    EXPECT_FALSE(cache.contains("d"));
+}
+
+TEST_F(TtsCacheTest, FileTimesKeepTheUsageOrderAcrossRestarts) {
+    qint64 bytes = entryBytes();
+    {
+        TtsCache cache(m_dir.path());
+        cache.insert("a", utterance("a"));
+        cache.insert("b", utterance("b"));
+        cache.insert("c", utterance("c"));
+    }
+
+    // "b" was used longest ago
+    QDateTime now = QDateTime::currentDateTime();
+    const std::pair<const char*, int> ages[] = {{"a", 10}, {"b", 60}, {"c", 30}};
+    for (const auto& [key, age] : ages) {
+        QFile file(entryPath(key));
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(file.setFileTime(now.addSecs(-age), QFileDevice::FileModificationTime));
+    }
+
+    TtsCache cache(m_dir.path(), bytes * 2 + bytes / 2);
+    EXPECT_TRUE(cache.contains("a"));
+    EXPECT_FALSE(cache.contains("b"));
+    EXPECT_TRUE(cache.contains("c"));
+}
+
+TEST_F(TtsCacheTest, CorruptFilesAreDroppedOnLookup) {
+    {
+        TtsCache cache(m_dir.path());
+        cache.insert("truncated", utterance("truncated"));
+        cache.insert("garbage", utterance("garbage"));
+        cache.insert("intact", utterance("intact"));
+    }
+    ASSERT_TRUE(QFile::resize(entryPath("truncated"), 100));
+    QFile garbage(entryPath("garbage"));
+    ASSERT_TRUE(garbage.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    garbage.write(QByteArray(5000, 'x'));
+    garbage.close();
+
+    TtsCache cache(m_dir.path());
+    EXPECT_FALSE(cache.lookup("truncated").has_value());
+    EXPECT_FALSE(cache.lookup("garbage").has_value());
+    EXPECT_FALSE(cache.contains("truncated"));
+    EXPECT_FALSE(QFile::exists(entryPath("truncated")));
+    EXPECT_FALSE(QFile::exists(entryPath("garbage")));
+    EXPECT_EQ(cache.stats().misses, 2u);
+
+    // Other entries are unaffected, and the dropped ones can be stored again
+    EXPECT_TRUE(cache.lookup("intact").has_value());
+    cache.insert("truncated", utterance("truncated"));
+    EXPECT_TRUE(cache.lookup("truncated").has_value());
+}
+
+} // namespace
+} // namespace Chatbot